@@ -0,0 +1,56 @@
+#ifndef AFINIDAD_H
+#define AFINIDAD_H
+
+#include <iostream>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <omp.h>
+#include "opciones.h" // Librerías que importar
+
+//AllowedCpus
+//0 Parametros
+//CPUs en las que el proceso puede correr (respeta taskset/cgroups).
+//Retorno la lista de CPUs
+inline std::vector<int> AllowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+        }
+    }
+    return cpus;
+}
+
+//PinThreads
+//1 Parametro
+//Fija cada hilo del equipo de OpenMP a una CPU. "close" pone los hilos en CPUs
+//consecutivas; "spread" los reparte a lo largo de todas las CPUs permitidas (por ejemplo,
+//uno por socket o por núcleo físico cuando hay SMT). OpenMP reutiliza los mismos hilos en
+//las regiones siguientes, así que basta con hacerlo una vez al inicio.
+//Retorno nulo
+inline void PinThreads(PinMode mode) {
+    if (mode == PIN_NONE) return;
+    const std::vector<int> cpus = AllowedCpus();
+    if (cpus.empty()) return;
+    const int numCpus = static_cast<int>(cpus.size());
+
+    #pragma omp parallel
+    {
+        const int tid = omp_get_thread_num();
+        const int numThreads = omp_get_num_threads();
+        int slot = tid % numCpus;
+        if (mode == PIN_SPREAD && numThreads < numCpus) {
+            slot = static_cast<int>(static_cast<long long>(tid) * numCpus / numThreads);
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[slot], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef ALEATORIO_H
+#define ALEATORIO_H
+
+#include <cstdint>
+#include <random> // Librerías que importar
+
+//Flujos independientes del generador, uno por cada uso.
+enum RngStream : uint64_t {
+    RNG_STREAM_CREATE = 1,   // Creación de partículas
+    RNG_STREAM_COLOR = 2     // Cambio de color aleatorio
+};
+
+//Mix64
+//1 Parametro
+//Función de mezcla de SplitMix64: cada bit de la entrada afecta a todos los de la salida.
+//Retorno el valor mezclado
+inline uint64_t Mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+//Generador basado en contador (SplitMix64). No guarda estado entre pasos: se crea para
+//cada partícula a partir de (semilla, flujo, índice, paso), por lo que los números de una
+//partícula son los mismos sin importar qué hilo la procese ni cuántos hilos haya. Crearlo
+//cuesta unas pocas multiplicaciones, a diferencia de std::random_device + std::mt19937.
+struct CounterRng {
+    uint64_t state;
+
+    CounterRng(uint64_t seed, uint64_t stream, uint64_t index, uint64_t step)
+        : state(Mix64(Mix64(Mix64(seed ^ Mix64(stream)) ^ index) ^ step)) {}
+
+    //Next
+    //0 Parametros
+    //Siguiente número de 64 bits.
+    //Retorno el número generado
+    uint64_t Next() {
+        state += 0x9E3779B97F4A7C15ull;
+        return Mix64(state);
+    }
+
+    //Uniform
+    //2 Parametros
+    //Número real uniforme en [low, high).
+    //Retorno el número generado
+    float Uniform(float low, float high) {
+        const float unit = static_cast<float>(Next() >> 40) * (1.0f / 16777216.0f); // 24 bits en [0, 1)
+        return low + (high - low) * unit;
+    }
+
+    //UniformInt
+    //2 Parametros
+    //Entero uniforme en [low, high].
+    //Retorno el número generado
+    int UniformInt(int low, int high) {
+        const uint64_t range = static_cast<uint64_t>(high - low) + 1;
+        return low + static_cast<int>(((Next() >> 32) * range) >> 32);
+    }
+};
+
+//RandomSeed
+//0 Parametros
+//Semilla nueva para cuando el usuario no da --seed. Es la única llamada a
+//std::random_device del programa.
+//Retorno la semilla
+inline uint64_t RandomSeed() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef COLISIONES_H
+#define COLISIONES_H
+
+#include <cmath>
+#include <omp.h>
+#include "particulas.h"
+#include "grilla.h" // Librerías que importar
+
+const float COLLISION_CELL = 2.0f * PARTICLE_RADIUS; //Celda del tamaño del mayor diámetro: dos círculos que se tocan quedan en celdas adyacentes.
+const int COLLISION_COLORS_X = 3;
+const int COLLISION_COLORS_Y = 2; //Pasadas por paso (3 x 2) sin celdas en conflicto.
+
+//CollidePair
+//3 Parametros
+//Choque elástico entre los círculos i y j (masa proporcional al área): los separa según
+//cuánto se traslapan y, si se acercan, intercambia la velocidad a lo largo de la normal.
+//Retorno verdadero si estaban en contacto
+inline bool CollidePair(ParticleSystem& p, int i, int j) {
+    const float dx = p.posX[j] - p.posX[i];
+    const float dy = p.posY[j] - p.posY[i];
+    const float reach = p.radius[i] + p.radius[j];
+    const float distance2 = dx * dx + dy * dy;
+    if (distance2 >= reach * reach || distance2 == 0.0f) return false;
+
+    const float distance = std::sqrt(distance2);
+    const float nx = dx / distance;
+    const float ny = dy / distance;
+    const float massI = p.radius[i] * p.radius[i];
+    const float massJ = p.radius[j] * p.radius[j];
+    const float inverseTotal = 1.0f / (massI + massJ);
+
+    //Separación: cada uno se mueve en proporción a la masa del otro.
+    const float overlap = reach - distance;
+    p.posX[i] -= nx * overlap * massJ * inverseTotal;
+    p.posY[i] -= ny * overlap * massJ * inverseTotal;
+    p.posX[j] += nx * overlap * massI * inverseTotal;
+    p.posY[j] += ny * overlap * massI * inverseTotal;
+
+    //Velocidad relativa a lo largo de la normal; solo se corrige si se están acercando.
+    const float approach = (p.velocityX[j] - p.velocityX[i]) * nx + (p.velocityY[j] - p.velocityY[i]) * ny;
+    if (approach < 0.0f) {
+        const float impulse = 2.0f * approach * inverseTotal;
+        p.velocityX[i] += impulse * massJ * nx;
+        p.velocityY[i] += impulse * massJ * ny;
+        p.velocityX[j] -= impulse * massI * nx;
+        p.velocityY[j] -= impulse * massI * ny;
+    }
+    return true;
+}
+
+//CollideCell
+//4 Parametros
+//Resuelve los contactos de la celda (cx, cy) consigo misma y con sus vecinas E, NE, N y
+//NO (media plantilla), así cada par de celdas adyacentes se revisa una sola vez. Solo
+//modifica partículas de las columnas cx-1..cx+1 y las filas cy..cy+1.
+//Retorno la cantidad de contactos resueltos
+inline long long CollideCell(ParticleSystem& p, const SpatialGrid& grid, int cx, int cy) {
+    static const int FORWARD[4][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 } };
+    const int c = cy * grid.cellsX + cx;
+    long long contacts = 0;
+
+    for (int a = grid.cellStart[c]; a < grid.cellStart[c + 1]; a++) {
+        const int i = grid.cellIndex[a];
+        for (int b = a + 1; b < grid.cellStart[c + 1]; b++) {
+            contacts += CollidePair(p, i, grid.cellIndex[b]);
+        }
+        for (const int* offset : FORWARD) {
+            const int gx = cx + offset[0];
+            const int gy = cy + offset[1];
+            if (gx < 0 || gx >= grid.cellsX || gy >= grid.cellsY) continue;
+            const int other = gy * grid.cellsX + gx;
+            for (int b = grid.cellStart[other]; b < grid.cellStart[other + 1]; b++) {
+                contacts += CollidePair(p, i, grid.cellIndex[b]);
+            }
+        }
+    }
+    return contacts;
+}
+
+//ResolveCollisions
+//2 Parametros
+//Resuelve los choques entre círculos de p (posiciones y velocidades, en el lugar) con la
+//grilla ya construida sobre esas posiciones. Las celdas se reparten en 3 x 2 colores según
+//(cx mod 3, cy mod 2); las celdas de un mismo color están tan separadas que las partículas
+//que modifica cada una no se cruzan, así cada color se reparte entre los hilos sin locks
+//ni atómicos. Los colores van siempre en el mismo orden y cada celda en orden fijo, por lo
+//que el resultado no depende de la cantidad de hilos. Es un "omp for" huérfano como los
+//demás kernels.
+//Retorno los contactos resueltos por este hilo (el que llama los suma)
+inline long long ResolveCollisions(ParticleSystem& p, const SpatialGrid& grid) {
+    long long contacts = 0;
+    for (int colorY = 0; colorY < COLLISION_COLORS_Y; colorY++) {
+        for (int colorX = 0; colorX < COLLISION_COLORS_X; colorX++) {
+            const int columns = (grid.cellsX - colorX + COLLISION_COLORS_X - 1) / COLLISION_COLORS_X;
+            const int rows = (grid.cellsY - colorY + COLLISION_COLORS_Y - 1) / COLLISION_COLORS_Y;
+
+            //Las celdas tienen cantidades de partículas muy distintas: reparto dinámico.
+            #pragma omp for schedule(dynamic, 1)
+            for (int k = 0; k < columns * rows; k++) {
+                const int cx = colorX + (k % columns) * COLLISION_COLORS_X;
+                const int cy = colorY + (k / columns) * COLLISION_COLORS_Y;
+                contacts += CollideCell(p, grid, cx, cy);
+            }
+        }
+    }
+    return contacts;
+}
+
+#endif
@@ -0,0 +1,632 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <omp.h>
+#include <mpi.h> // Librerías que importar
+#include "particulas.h"
+#include "grilla.h"
+#include "fases.h"
+#include "opciones.h"
+#include "medicion.h"
+#include "instantanea.h"
+#include "aleatorio.h"
+#include "afinidad.h"
+
+//Simulación repartida entre procesos MPI, sin ventana. El mundo (una o varias ventanas de
+//ancho, --wall) se divide en franjas verticales de columnas de la grilla de vecinos y cada
+//rango simula las partículas de su franja con OpenMP, con el mismo paso que paralela.cpp.
+//Como las franjas empiezan y terminan en bordes de celda, cada celda tiene partículas de un
+//solo rango y, dentro de ella, en orden de identificador: la grilla de cada rango recorre
+//los mismos candidatos en el mismo orden que la grilla completa y el resultado es idéntico,
+//bit a bit, al de paralela.cpp con la misma semilla.
+
+//Partícula que cambia de rango: su identificador (índice en paralela.cpp) y sus columnas.
+struct Migrant {
+    int id;
+    float columns[ParticleSystem::NUM_COLUMNS];
+};
+
+const int HALO_FIELDS = 5; //x, y, r, g, b de cada partícula prestada a un vecino.
+
+//Franja de la grilla que simula un rango. Las partículas propias ocupan [0, count) del
+//frente, ordenadas por identificador; durante el paso las prestadas por los vecinos (halo)
+//se copian a continuación, en [count, count + halo).
+struct Domain {
+    ParticleSystem buffers[2];
+    int front = 0;
+    std::vector<int> ids;            // Identificador de cada partícula propia del frente
+    std::vector<int> scratchIds;     // Identificadores del frente nuevo al migrar
+    int firstColumn = 0;             // Columnas [firstColumn, endColumn) de la grilla
+    int endColumn = 0;
+    int left = MPI_PROC_NULL;        // Rangos vecinos (MPI_PROC_NULL en los bordes del mundo)
+    int right = MPI_PROC_NULL;
+    long long step = 0;              // Pasos simulados (contador del generador aleatorio)
+
+    ParticleSystem& Front() { return buffers[front]; }
+    ParticleSystem& Back() { return buffers[front ^ 1]; }
+    const ParticleSystem& Front() const { return buffers[front]; }
+};
+
+Domain domain; //Franja de este rango.
+SpatialGrid grid; //Grilla para buscar vecinos (de todo el mundo; solo se llenan las celdas de la franja y el halo).
+std::vector<float> sortedColorR, sortedColorG, sortedColorB; //Colores en el orden de la grilla.
+std::vector<float> haloSendLeft, haloSendRight, haloReceiveLeft, haloReceiveRight;
+std::vector<Migrant> migrantsLeft, migrantsRight, arrivalsLeft, arrivalsRight, arrivals;
+std::vector<int> destination; //Posición nueva de cada partícula que se queda (-1 si se va).
+std::vector<int> arrivalDestination; //Posición nueva de cada partícula que llega.
+
+int rank = 0;
+int numRanks = 1;
+int numParticlesToCreate = 0;
+uint64_t simulationSeed = 0;
+float simulationStep = 1.0f / DEFAULT_SIMULATION_HZ;
+float worldWidth = WINDOW_WIDTH; //Ancho del mundo (--wall ventanas).
+long long haloParticles = 0; //Partículas prestadas a los vecinos (suma de todos los pasos).
+long long migratedParticles = 0; //Partículas que cambiaron de rango (suma de todos los pasos).
+double haloSeconds = 0.0;
+double migrationSeconds = 0.0;
+
+//FirstColumn
+//2 Parametros
+//Primera columna de la grilla del rango r de ranks; las columnas se reparten en partes
+//casi iguales.
+//Retorno la columna
+int FirstColumn(int r, int ranks) {
+    return static_cast<int>(static_cast<long long>(grid.cellsX) * r / ranks);
+}
+
+//ColumnOwner
+//1 Parametro
+//Rango que simula la columna c de la grilla.
+//Retorno el rango
+int ColumnOwner(int c) {
+    int r = static_cast<int>(static_cast<long long>(c) * numRanks / grid.cellsX);
+    while (r + 1 < numRanks && FirstColumn(r + 1, numRanks) <= c) r++;
+    while (r > 0 && FirstColumn(r, numRanks) > c) r--;
+    return r;
+}
+
+//InitDomain
+//3 Parametros
+//Asigna a d la franja del rango r de ranks y sus vecinos, y reserva los arreglos. La
+//capacidad es el total de partículas: la memoria de AllocateArena solo se asigna al
+//escribirla, así que cada rango ocupa lo que usa aunque su franja se llene de partículas.
+//Retorno nulo
+void InitDomain(Domain& d, int r, int ranks) {
+    d.firstColumn = FirstColumn(r, ranks);
+    d.endColumn = FirstColumn(r + 1, ranks);
+    d.left = r > 0 ? r - 1 : MPI_PROC_NULL;
+    d.right = r + 1 < ranks ? r + 1 : MPI_PROC_NULL;
+    for (ParticleSystem& buffer : d.buffers) {
+        buffer.Allocate(numParticlesToCreate);
+        buffer.count = 0;
+    }
+    d.front = 0;
+    d.step = 0;
+    d.ids.clear();
+}
+
+//CreateMigrant
+//1 Parametro
+//Partícula id del estado inicial, con el mismo generador que CreateParticle de paralela.cpp.
+//Retorno la partícula con todas sus columnas
+Migrant CreateMigrant(int id) {
+    CounterRng generator(simulationSeed, RNG_STREAM_CREATE, id, 0);
+
+    const float radius = generator.Uniform(20.0f, PARTICLE_RADIUS);
+    const float vx = generator.Uniform(-MAX_SPEED, MAX_SPEED);
+    const float vy = generator.Uniform(-MAX_SPEED, MAX_SPEED);
+    const float x = generator.Uniform(-worldWidth / 2 + PARTICLE_RADIUS, worldWidth / 2 - PARTICLE_RADIUS);
+    const float y = generator.Uniform(-WINDOW_HEIGHT / 2 + PARTICLE_RADIUS, WINDOW_HEIGHT / 2 - PARTICLE_RADIUS);
+    const float r = generator.Uniform(0.0f, 1.0f);
+    const float g = generator.Uniform(0.0f, 1.0f);
+    const float b = generator.Uniform(0.0f, 1.0f);
+
+    //Mismo orden que ParticleSystem::COLUMNS.
+    return Migrant{ id, { vx, vy, x, y, r, g, b, 0.0f, radius, x, y } };
+}
+
+//StoreParticle
+//3 Parametros
+//Copia las columnas de m a la posición i de p.
+//Retorno nulo
+inline void StoreParticle(const Migrant& m, ParticleSystem& p, int i) {
+    for (int k = 0; k < ParticleSystem::NUM_COLUMNS; k++) {
+        (p.*ParticleSystem::COLUMNS[k])[i] = m.columns[k];
+    }
+}
+
+//LoadParticle
+//3 Parametros
+//Copia la partícula i de p (con identificador id) a una Migrant.
+//Retorno la partícula
+inline Migrant LoadParticle(const ParticleSystem& p, int i, int id) {
+    Migrant m;
+    m.id = id;
+    for (int k = 0; k < ParticleSystem::NUM_COLUMNS; k++) {
+        m.columns[k] = (p.*ParticleSystem::COLUMNS[k])[i];
+    }
+    return m;
+}
+
+//CreateParticles
+//0 Parametros
+//Estado inicial repartido: cada rango crea un tramo contiguo de identificadores (en
+//paralelo) y los envía al rango de su columna con MPI_Alltoallv. Como los tramos llegan en
+//orden de rango, cada rango recibe sus partículas ya ordenadas por identificador.
+//Retorno nulo
+void CreateParticles() {
+    const int begin = static_cast<int>(static_cast<long long>(numParticlesToCreate) * rank / numRanks);
+    const int end = static_cast<int>(static_cast<long long>(numParticlesToCreate) * (rank + 1) / numRanks);
+    std::vector<Migrant> created(end - begin);
+    std::vector<int> owner(end - begin);
+
+    #pragma omp parallel for schedule(static)
+    for (int i = begin; i < end; i++) {
+        created[i - begin] = CreateMigrant(i);
+        owner[i - begin] = ColumnOwner(grid.CellX(created[i - begin].columns[2]));
+    }
+
+    //Agrupa por rango destino sin cambiar el orden (counting sort estable).
+    std::vector<int> sendCounts(numRanks, 0), sendOffsets(numRanks + 1, 0);
+    for (int o : owner) sendCounts[o]++;
+    for (int r = 0; r < numRanks; r++) sendOffsets[r + 1] = sendOffsets[r] + sendCounts[r];
+    std::vector<Migrant> packed(created.size());
+    std::vector<int> next(sendOffsets.begin(), sendOffsets.end() - 1);
+    for (size_t i = 0; i < created.size(); i++) packed[next[owner[i]]++] = created[i];
+
+    std::vector<int> receiveCounts(numRanks);
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, receiveCounts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    std::vector<int> sendBytes(numRanks), sendDisplacements(numRanks), receiveBytes(numRanks), receiveDisplacements(numRanks);
+    int received = 0;
+    for (int r = 0; r < numRanks; r++) {
+        sendBytes[r] = sendCounts[r] * static_cast<int>(sizeof(Migrant));
+        sendDisplacements[r] = sendOffsets[r] * static_cast<int>(sizeof(Migrant));
+        receiveBytes[r] = receiveCounts[r] * static_cast<int>(sizeof(Migrant));
+        receiveDisplacements[r] = received * static_cast<int>(sizeof(Migrant));
+        received += receiveCounts[r];
+    }
+    std::vector<Migrant> mine(received);
+    MPI_Alltoallv(packed.data(), sendBytes.data(), sendDisplacements.data(), MPI_BYTE,
+                  mine.data(), receiveBytes.data(), receiveDisplacements.data(), MPI_BYTE, MPI_COMM_WORLD);
+
+    ParticleSystem& front = domain.Front();
+    front.count = received;
+    domain.ids.resize(received);
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < received; i++) {
+        StoreParticle(mine[i], front, i);           // La primera escritura asigna las páginas en el nodo del hilo
+        domain.ids[i] = mine[i].id;
+    }
+}
+
+//ExchangeHalo
+//1 Parametro
+//Presta a cada vecino las partículas propias de la columna que toca con él (posición y
+//color del frente) y copia las que prestan los vecinos después de las propias. Las
+//partículas a menos de NEIGHBOR_RADIUS de la franja están todas en esas columnas.
+//Retorno la cantidad de partículas prestadas por los vecinos
+int ExchangeHalo(Domain& d) {
+    ParticleSystem& front = d.Front();
+    const int n = front.count;
+    haloSendLeft.clear();
+    haloSendRight.clear();
+    for (int i = 0; i < n; i++) {
+        const int c = grid.CellX(front.posX[i]);
+        const float fields[HALO_FIELDS] = { front.posX[i], front.posY[i], front.colorR[i], front.colorG[i], front.colorB[i] };
+        if (c == d.firstColumn && d.left != MPI_PROC_NULL) haloSendLeft.insert(haloSendLeft.end(), fields, fields + HALO_FIELDS);
+        if (c == d.endColumn - 1 && d.right != MPI_PROC_NULL) haloSendRight.insert(haloSendRight.end(), fields, fields + HALO_FIELDS);
+    }
+
+    //Primero los tamaños y luego los datos, hacia la izquierda y hacia la derecha.
+    int sendLeft = static_cast<int>(haloSendLeft.size()), sendRight = static_cast<int>(haloSendRight.size());
+    int receiveLeft = 0, receiveRight = 0;
+    MPI_Sendrecv(&sendLeft, 1, MPI_INT, d.left, 0, &receiveRight, 1, MPI_INT, d.right, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&sendRight, 1, MPI_INT, d.right, 1, &receiveLeft, 1, MPI_INT, d.left, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    haloReceiveLeft.resize(receiveLeft);
+    haloReceiveRight.resize(receiveRight);
+    MPI_Sendrecv(haloSendLeft.data(), sendLeft, MPI_FLOAT, d.left, 2, haloReceiveRight.data(), receiveRight, MPI_FLOAT, d.right, 2, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(haloSendRight.data(), sendRight, MPI_FLOAT, d.right, 3, haloReceiveLeft.data(), receiveLeft, MPI_FLOAT, d.left, 3, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    //Las prestadas van después de las propias, en el orden en que llegaron (por identificador).
+    int h = n;
+    for (const std::vector<float>* halo : { &haloReceiveLeft, &haloReceiveRight }) {
+        for (size_t f = 0; f < halo->size(); f += HALO_FIELDS, h++) {
+            front.posX[h] = (*halo)[f];
+            front.posY[h] = (*halo)[f + 1];
+            front.colorR[h] = (*halo)[f + 2];
+            front.colorG[h] = (*halo)[f + 3];
+            front.colorB[h] = (*halo)[f + 4];
+        }
+    }
+    return h - n;
+}
+
+//Migrate
+//1 Parametro
+//Después de un paso (estado nuevo en Back()), envía a los vecinos las partículas que
+//salieron de la franja y arma el frente nuevo con las que se quedan y las que llegaron,
+//mezcladas por identificador para que cada celda siga en orden. El paso no mueve una
+//partícula más de una franja (main lo revisa), así que solo se habla con los vecinos.
+//Retorno nulo
+void Migrate(Domain& d) {
+    ParticleSystem& back = d.Back();
+    const int n = back.count;
+    migrantsLeft.clear();
+    migrantsRight.clear();
+    destination.resize(n);
+    for (int i = 0; i < n; i++) {
+        const int c = grid.CellX(back.posX[i]);
+        destination[i] = 0;
+        if (c < d.firstColumn) {
+            migrantsLeft.push_back(LoadParticle(back, i, d.ids[i]));
+            destination[i] = -1;
+        } else if (c >= d.endColumn) {
+            migrantsRight.push_back(LoadParticle(back, i, d.ids[i]));
+            destination[i] = -1;
+        }
+    }
+
+    int sendLeft = static_cast<int>(migrantsLeft.size()), sendRight = static_cast<int>(migrantsRight.size());
+    int receiveLeft = 0, receiveRight = 0;
+    MPI_Sendrecv(&sendLeft, 1, MPI_INT, d.left, 4, &receiveRight, 1, MPI_INT, d.right, 4, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&sendRight, 1, MPI_INT, d.right, 5, &receiveLeft, 1, MPI_INT, d.left, 5, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    arrivalsLeft.resize(receiveLeft);
+    arrivalsRight.resize(receiveRight);
+    const int bytes = static_cast<int>(sizeof(Migrant));
+    MPI_Sendrecv(migrantsLeft.data(), sendLeft * bytes, MPI_BYTE, d.left, 6, arrivalsRight.data(), receiveRight * bytes, MPI_BYTE, d.right, 6, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(migrantsRight.data(), sendRight * bytes, MPI_BYTE, d.right, 7, arrivalsLeft.data(), receiveLeft * bytes, MPI_BYTE, d.left, 7, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    migratedParticles += sendLeft + sendRight;
+
+    if (sendLeft + sendRight + receiveLeft + receiveRight == 0) {
+        d.front ^= 1;                               // Nadie sale ni entra: el estado nuevo ya es el frente
+        return;
+    }
+
+    //Posiciones del frente nuevo: mezcla por identificador de las que se quedan y las que llegan.
+    arrivals.resize(receiveLeft + receiveRight);
+    std::merge(arrivalsLeft.begin(), arrivalsLeft.end(), arrivalsRight.begin(), arrivalsRight.end(), arrivals.begin(),
+               [](const Migrant& a, const Migrant& b) { return a.id < b.id; });
+    const int count = n - sendLeft - sendRight + receiveLeft + receiveRight;
+    d.scratchIds.resize(count);
+    arrivalDestination.resize(arrivals.size());
+    int out = 0;
+    size_t a = 0;
+    for (int i = 0; i < n; i++) {
+        if (destination[i] < 0) continue;
+        while (a < arrivals.size() && arrivals[a].id < d.ids[i]) arrivalDestination[a++] = out++;
+        destination[i] = out++;
+    }
+    while (a < arrivals.size()) arrivalDestination[a++] = out++;
+
+    //El frente anterior ya no se usa: se llena con el estado nuevo en su lugar final.
+    ParticleSystem& front = d.Front();
+    #pragma omp parallel
+    {
+        for (int k = 0; k < ParticleSystem::NUM_COLUMNS; k++) {
+            const float* src = back.*ParticleSystem::COLUMNS[k];
+            float* dst = front.*ParticleSystem::COLUMNS[k];
+            #pragma omp for schedule(static) nowait
+            for (int i = 0; i < n; i++) {
+                if (destination[i] >= 0) dst[destination[i]] = src[i];
+            }
+        }
+        #pragma omp for schedule(static)
+        for (int i = 0; i < n; i++) {
+            if (destination[i] >= 0) d.scratchIds[destination[i]] = d.ids[i];
+        }
+    }
+    for (size_t m = 0; m < arrivals.size(); m++) {
+        StoreParticle(arrivals[m], front, arrivalDestination[m]);
+        d.scratchIds[arrivalDestination[m]] = arrivals[m].id;
+    }
+    front.count = count;
+    front.time = back.time;
+    front.batchTime = back.batchTime;
+    d.ids.swap(d.scratchIds);
+}
+
+//StepParticles
+//3 Parametros
+//Avanza la franja d substeps pasos de deltaTime segundos con las fases de paralela.cpp
+//(IntegrateParticles y las de fases.h): grilla (con el halo), integración, cambio de color
+//y promedio de vecinos.
+//Solo se actualizan las partículas propias; las del halo solo se leen. Después migra las
+//que salieron de la franja.
+//Retorno nulo
+void StepParticles(Domain& d, float deltaTime, int substeps) {
+    const ParticleSystem& front = d.Front();
+    ParticleSystem& back = d.Back();
+    const int n = front.count;
+    long long pairs = 0;
+
+    Clock::time_point mark = Clock::now();
+    const int halo = ExchangeHalo(d);
+    const int m = n + halo;
+    haloParticles += halo;
+    haloSeconds += std::chrono::duration<double>(Clock::now() - mark).count();
+    if (sortedColorR.size() < static_cast<size_t>(m)) {
+        sortedColorR.resize(m);
+        sortedColorG.resize(m);
+        sortedColorB.resize(m);
+    }
+    back.count = n;
+    phaseTimer.Start();
+
+    #pragma omp parallel
+    {
+        {
+            PERFIL_FASE(PHASE_GRID);
+            grid.Build(front.posX, front.posY, m);     // Propias y prestadas
+            grid.Gather(front.colorR, sortedColorR.data());
+            grid.Gather(front.colorG, sortedColorG.data());
+            grid.Gather(front.colorB, sortedColorB.data());
+        }
+        #pragma omp master
+        phaseTimer.Lap(PHASE_GRID);
+
+        {
+            PERFIL_FASE(PHASE_INTEGRATION);
+            IntegrateParticles(front, back, deltaTime, substeps, worldWidth);
+        }
+        #pragma omp master
+        phaseTimer.Lap(PHASE_INTEGRATION);
+
+        {
+            PERFIL_FASE(PHASE_COLOR);
+            //Generador de la partícula por su identificador, igual que en paralela.cpp.
+            ChangeColors(front, back, n, d.ids.data(), simulationSeed, d.step, deltaTime * substeps); // fases.h
+        }
+        #pragma omp master
+        phaseTimer.Lap(PHASE_COLOR);
+
+        {
+            PERFIL_FASE(PHASE_NEIGHBORS);
+            //Recorre propias y prestadas, pero solo escribe las propias (índice menor que n).
+            const long long mine = AverageNeighborColors(grid, sortedColorR.data(), sortedColorG.data(), sortedColorB.data(), n, back);
+            #pragma omp atomic
+            pairs += mine;
+        }
+    }
+    phaseTimer.Lap(PHASE_NEIGHBORS);
+    neighborPairs += pairs;
+
+    back.time = front.time + static_cast<double>(deltaTime) * substeps;
+    back.batchTime = static_cast<double>(deltaTime) * substeps;
+    mark = Clock::now();
+    Migrate(d);                                         // El estado nuevo queda en Front()
+    migrationSeconds += std::chrono::duration<double>(Clock::now() - mark).count();
+    d.step++;
+}
+
+//GatherState
+//2 Parametros
+//Junta en full, en el rango 0, las partículas de todos los rangos en el orden de su
+//identificador (el mismo de paralela.cpp). Todos los rangos deben llamarla.
+//Retorno nulo
+void GatherState(const Domain& d, ParticleSystem& full) {
+    const ParticleSystem& front = d.Front();
+    const int n = front.count;
+    std::vector<int> counts(numRanks), offsets(numRanks + 1, 0);
+    MPI_Gather(&n, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    for (int r = 0; r < numRanks; r++) offsets[r + 1] = offsets[r] + counts[r];
+
+    std::vector<int> ids(rank == 0 ? offsets[numRanks] : 0);
+    std::vector<float> values(ids.size());
+    MPI_Gatherv(d.ids.data(), n, MPI_INT, ids.data(), counts.data(), offsets.data(), MPI_INT, 0, MPI_COMM_WORLD);
+    for (int k = 0; k < ParticleSystem::NUM_COLUMNS; k++) {
+        MPI_Gatherv(front.*ParticleSystem::COLUMNS[k], n, MPI_FLOAT, values.data(), counts.data(), offsets.data(), MPI_FLOAT, 0, MPI_COMM_WORLD);
+        if (rank != 0) continue;
+        float* column = full.*ParticleSystem::COLUMNS[k];
+        for (size_t j = 0; j < ids.size(); j++) column[ids[j]] = values[j];
+    }
+    full.time = front.time;
+    full.batchTime = front.batchTime;
+}
+
+//VerifyDistributed
+//1 Parametro
+//Corre steps pasos repartidos entre todos los rangos y, en el rango 0, los mismos pasos
+//con todo el mundo en una sola franja y un hilo (el algoritmo de paralela.cpp). Después de
+//cada paso junta el estado repartido y lo compara bit a bit.
+//Retorno 0 si todos los pasos son idénticos, 1 si no
+int VerifyDistributed(int steps) {
+    const float deltaTime = simulationStep;
+    const int threads = omp_get_max_threads();
+    Domain reference;
+    ParticleSystem gathered;
+    if (rank == 0) {
+        InitDomain(reference, 0, 1);                    // Todo el mundo, sin vecinos
+        gathered.Allocate(numParticlesToCreate);
+        ParticleSystem& front = reference.Front();
+        front.count = numParticlesToCreate;
+        reference.ids.resize(numParticlesToCreate);
+        for (int i = 0; i < numParticlesToCreate; i++) {
+            StoreParticle(CreateMigrant(i), front, i);
+            reference.ids[i] = i;
+        }
+    }
+    CreateParticles();
+
+    int result = 0;
+    for (int s = 0; s < steps && result == 0; s++) {
+        const int substeps = s % 3 + 1; //También prueba tandas de subpasos fusionados
+        if (rank == 0) {
+            omp_set_num_threads(1);
+            StepParticles(reference, deltaTime, substeps);
+            omp_set_num_threads(threads);
+        }
+        StepParticles(domain, deltaTime, substeps);
+        GatherState(domain, gathered);
+
+        int column = 0, index = 0;
+        if (rank == 0 && !FindMismatch(reference.Front(), gathered, column, index)) {
+            std::cout << "Diferencia en el paso " << s + 1 << ", partícula " << index << ", campo " << COLUMN_NAMES[column]
+                      << ": una franja " << (reference.Front().*ParticleSystem::COLUMNS[column])[index]
+                      << ", " << numRanks << " rangos " << (gathered.*ParticleSystem::COLUMNS[column])[index] << "\n";
+            result = 1;
+        }
+        MPI_Bcast(&result, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    }
+    if (result == 0) {
+        std::cout << "Verificación correcta: " << steps << " pasos con " << numRanks << " rangos de " << threads
+                  << " hilos idénticos a una franja con 1 hilo.\n";
+    }
+    return result;
+}
+
+//WriteCheckpoint
+//2 Parametros
+//Junta el estado en el rango 0 y lo guarda como instantánea de instantanea.h; con --wall 1
+//la misma que escribiría paralela.cpp, así que se puede abrir con ./par --load.
+//Retorno nulo
+void WriteCheckpoint(const char* path, ParticleSystem& full) {
+    GatherState(domain, full);
+    if (rank == 0 && !WriteSnapshot(path, SnapshotTemporaryPath(path).c_str(), full, static_cast<uint64_t>(domain.step), simulationSeed)) {
+        std::cout << "No se pudo guardar la instantánea en " << path << "\n";
+    }
+}
+
+//RunDistributed
+//4 Parametros
+//Versión repartida de RunHeadless: crea las partículas, simula steps pasos y reporta, en el
+//rango 0, la latencia por paso, las partículas por segundo, el halo y la migración por
+//paso, el desbalance entre rangos y el tiempo de cada fase (el del rango más lento). Con
+//checkpointPath guarda instantáneas cada checkpointEvery pasos y al terminar.
+//Retorno nulo
+void RunDistributed(int steps, bool csv, const char* checkpointPath, int checkpointEvery) {
+    std::vector<double> latencies(steps);
+    ParticleSystem full;
+    if (checkpointPath != nullptr && rank == 0) full.Allocate(numParticlesToCreate);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    Clock::time_point startTime = Clock::now();
+    CreateParticles();
+    double creationTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    phaseTimer.Reset();
+    neighborPairs = 0;
+    haloParticles = 0;
+    migratedParticles = 0;
+    haloSeconds = 0.0;
+    migrationSeconds = 0.0;
+    int largest = domain.Front().count;
+    MPI_Barrier(MPI_COMM_WORLD);
+    Clock::time_point loopStart = Clock::now();
+    for (int s = 0; s < steps; s++) {
+        Clock::time_point stepStart = Clock::now();
+        StepParticles(domain, simulationStep, 1);
+        latencies[s] = std::chrono::duration<double>(Clock::now() - stepStart).count();
+        largest = std::max(largest, domain.Front().count);
+        if (checkpointPath != nullptr && domain.step % checkpointEvery == 0 && s + 1 < steps) {
+            WriteCheckpoint(checkpointPath, full);
+        }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    double loopTime = std::chrono::duration<double>(Clock::now() - loopStart).count();
+    if (checkpointPath != nullptr) {
+        WriteCheckpoint(checkpointPath, full);
+        std::cout << "Instantánea final (paso " << domain.step << ") en " << checkpointPath << "\n";
+    }
+
+    //Totales de todos los rangos; los tiempos son los del rango más lento.
+    long long totals[3] = { neighborPairs, haloParticles, migratedParticles };
+    double slowest[NUM_SIM_PHASES + 3];
+    std::copy(phaseTimer.total, phaseTimer.total + NUM_SIM_PHASES, slowest);
+    slowest[NUM_SIM_PHASES] = haloSeconds;
+    slowest[NUM_SIM_PHASES + 1] = migrationSeconds;
+    slowest[NUM_SIM_PHASES + 2] = creationTime;
+    MPI_Allreduce(MPI_IN_PLACE, totals, 3, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, slowest, NUM_SIM_PHASES + 3, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &largest, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &loopTime, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    std::sort(latencies.begin(), latencies.end());
+    const double particleSteps = static_cast<double>(numParticlesToCreate) * steps;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Partículas: " << numParticlesToCreate << ", pasos: " << steps << ", rangos: " << numRanks
+              << ", hilos por rango: " << omp_get_max_threads() << "\n";
+    std::cout << "Creación: " << slowest[NUM_SIM_PHASES + 2] * 1e3 << " ms\n";
+    std::cout << "Tiempo total: " << loopTime * 1e3 << " ms\n";
+    std::cout << "Latencia por paso (ms, rango 0): p50 " << Percentile(latencies, 50) * 1e3
+              << "  p90 " << Percentile(latencies, 90) * 1e3
+              << "  p99 " << Percentile(latencies, 99) * 1e3
+              << "  max " << latencies.back() * 1e3 << "\n";
+    std::cout << "Partículas actualizadas por segundo: " << std::setprecision(0) << particleSteps / loopTime << "\n";
+    std::cout << std::setprecision(3);
+    std::cout << "Vecinos promedio por partícula: " << static_cast<double>(totals[0]) / particleSteps << "\n";
+    std::cout << "Halo por paso: " << static_cast<double>(totals[1]) / steps << " partículas, migración por paso: "
+              << static_cast<double>(totals[2]) / steps << " partículas\n";
+    std::cout << "Desbalance: el rango más cargado tuvo " << static_cast<double>(largest) * numRanks / std::max(numParticlesToCreate, 1)
+              << " veces el promedio de partículas\n";
+    for (int p = 0; p < NUM_SIM_PHASES; p++) {
+        if (p == PHASE_COLLISIONS) continue;
+        std::cout << "  " << PHASE_NAMES[p] << ": " << slowest[p] * 1e3 << " ms (" << slowest[p] / steps * 1e3 << " ms/paso)\n";
+    }
+    std::cout << "  Halo: " << slowest[NUM_SIM_PHASES] * 1e3 << " ms (" << slowest[NUM_SIM_PHASES] / steps * 1e3 << " ms/paso)\n";
+    std::cout << "  Migración: " << slowest[NUM_SIM_PHASES + 1] * 1e3 << " ms (" << slowest[NUM_SIM_PHASES + 1] / steps * 1e3 << " ms/paso)\n";
+    if (csv) {
+        //particulas,pasos,segundos,p50_ms,p99_ms,particulas_por_segundo,rangos,hilos
+        std::cout << std::setprecision(6) << "CSV," << numParticlesToCreate << "," << steps << "," << loopTime << ","
+                  << Percentile(latencies, 50) * 1e3 << "," << Percentile(latencies, 99) * 1e3 << ","
+                  << std::setprecision(0) << particleSteps / loopTime << "," << numRanks << "," << omp_get_max_threads() << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided); // Solo el hilo principal llama a MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+    if (rank != 0) std::cout.rdbuf(nullptr);            // Solo el rango 0 escribe mensajes
+
+    Options opts = ParseOptions(argc, argv);             // Todos los rangos leen las mismas opciones
+    if (opts.collisions || opts.verlet || !opts.neighbors || opts.kernels || opts.checkAlloc || opts.loadPath != nullptr
+        || opts.recordPath != nullptr || opts.replayPath != nullptr || opts.offscreen || opts.tracePath != nullptr) {
+        std::cout << "distribuida no tiene --collisions, --verlet, --no-neighbors, --kernels, --check-alloc, --load, --record, --replay, --offscreen ni --trace. Se ignoran.\n";
+    }
+    numParticlesToCreate = opts.numParticles;
+    simulationStep = 1.0f / opts.simulationHz;
+    worldWidth = static_cast<float>(WINDOW_WIDTH) * opts.wall;
+    simulationSeed = opts.hasSeed ? opts.seed : RandomSeed();
+    MPI_Bcast(&simulationSeed, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD); // La semilla del rango 0 para todos
+    std::cout << "Semilla: " << simulationSeed << "\n";
+
+    if (opts.threads > 0) {
+        omp_set_num_threads(opts.threads);              // Hilos por rango (--threads)
+    }
+    PinThreads(opts.pin);                               // Dentro de las CPUs que mpirun le dio al rango
+    omp_set_schedule(opts.schedule, opts.scheduleChunk);
+
+    //Cada franja debe tener al menos una columna y ningún paso puede cruzar una franja entera.
+    grid.Init(-worldWidth / 2, -WINDOW_HEIGHT / 2, worldWidth, WINDOW_HEIGHT); // Celdas de NEIGHBOR_RADIUS
+    const int maxSubsteps = opts.verify ? 3 : 1;
+    const float narrowest = grid.cellSize * (grid.cellsX / numRanks);
+    if (numRanks > grid.cellsX || MAX_SPEED * simulationStep * maxSubsteps > narrowest) {
+        std::cout << "Con " << numRanks << " rangos las franjas miden " << narrowest << " px y un paso mueve hasta "
+                  << MAX_SPEED * simulationStep * maxSubsteps << " px. Use menos rangos, más --hz o más --wall.\n";
+        MPI_Finalize();
+        return 1;
+    }
+
+    try {
+        InitDomain(domain, rank, numRanks);             // Franja de este rango
+    } catch (const std::bad_alloc&) {
+        std::cout << "No hay memoria para " << numParticlesToCreate << " partículas.\n";
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    std::cout << "Rangos: " << numRanks << " (franjas de " << grid.cellsX / numRanks << " a "
+              << (grid.cellsX + numRanks - 1) / numRanks << " columnas), hilos por rango: " << omp_get_max_threads() << "\n";
+
+    int result = 0;
+    if (opts.verify) {
+        result = VerifyDistributed(opts.steps);         // Compara contra una sola franja
+    } else {
+        RunDistributed(opts.steps, opts.csv, opts.checkpointPath, opts.checkpointEvery);
+    }
+    MPI_Finalize();
+    return result;
+}
@@ -0,0 +1,68 @@
+#!/bin/bash
+# Estudio de escalamiento fuerte y débil del kernel paralelo contra el secuencial.
+# Corre ./sec y ./par en modo headless (compilados como indica el README) y escribe CSV
+# con el tiempo, speedup y eficiencia paralela de cada combinación.
+#
+# Uso: ./escalamiento.sh [pasos] [hilos] [particulas] [base_debil] > resultados.csv
+#   pasos       pasos por corrida (por defecto 200)
+#   hilos       lista de hilos separada por comas (por defecto 1,2,4,... hasta nproc)
+#   particulas  lista de tamaños para escalamiento fuerte (por defecto 10000,50000,100000)
+#   base_debil  partículas por hilo para escalamiento débil (por defecto 10000)
+# Variables: SEC y PAR cambian los ejecutables, PIN la afinidad (none|close|spread) y EXTRA
+# agrega opciones a ambos programas, por ejemplo EXTRA=--collisions para medir los choques:
+#   EXTRA=--collisions ./escalamiento.sh 5 "" 100000,200000 50000 > choques.csv
+
+STEPS=${1:-200}
+THREADS=${2:-}
+SIZES=${3:-10000,50000,100000}
+WEAK_BASE=${4:-10000}
+SEC=${SEC:-./sec}
+PAR=${PAR:-./par}
+PIN=${PIN:-close}
+SEED=${SEED:-1}
+EXTRA=${EXTRA:-}
+
+if [ -z "$THREADS" ]; then
+    # Potencias de 2 hasta la cantidad de CPUs, más la cantidad de CPUs.
+    MAX=$(nproc)
+    THREADS=""
+    for ((t = 1; t < MAX; t *= 2)); do THREADS="$THREADS$t,"; done
+    THREADS="$THREADS$MAX"
+fi
+
+for exe in "$SEC" "$PAR"; do
+    if [ ! -x "$exe" ]; then
+        echo "No se encontró $exe. Compile los programas como indica el README." >&2
+        exit 1
+    fi
+done
+
+# seconds PROGRAMA PARTICULAS [opciones...]: segundos de simulación del resumen CSV.
+seconds() {
+    local exe=$1 n=$2
+    shift 2
+    "$exe" "$n" --headless --steps "$STEPS" --seed "$SEED" --csv $EXTRA "$@" | awk -F, '/^CSV,/ { print $4 }'
+}
+
+echo "tipo,particulas,hilos,segundos,speedup,eficiencia"
+
+# Escalamiento fuerte: mismo tamaño, más hilos.
+for n in ${SIZES//,/ }; do
+    base=$(seconds "$SEC" "$n")
+    echo "secuencial,$n,1,$base,1.000,1.000"
+    for t in ${THREADS//,/ }; do
+        time=$(seconds "$PAR" "$n" --threads "$t" --pin "$PIN")
+        awk -v n="$n" -v t="$t" -v b="$base" -v p="$time" \
+            'BEGIN { s = b / p; printf "fuerte,%d,%d,%s,%.3f,%.3f\n", n, t, p, s, s / t }'
+    done
+done
+
+# Escalamiento débil: las partículas crecen con los hilos. La referencia es el programa
+# secuencial con el mismo tamaño, así la eficiencia ideal sigue siendo 1.
+for t in ${THREADS//,/ }; do
+    n=$((WEAK_BASE * t))
+    base=$(seconds "$SEC" "$n")
+    time=$(seconds "$PAR" "$n" --threads "$t" --pin "$PIN")
+    awk -v n="$n" -v t="$t" -v b="$base" -v p="$time" \
+        'BEGIN { s = b / p; printf "debil,%d,%d,%s,%.3f,%.3f\n", n, t, p, s, s / t }'
+done
@@ -0,0 +1,57 @@
+#!/bin/bash
+# Escalamiento débil de la simulación repartida con MPI. Cada rango simula una ventana de
+# la pared (--wall igual a la cantidad de rangos) con la misma cantidad de partículas, así
+# la densidad y el trabajo por rango no cambian y el tiempo ideal es el de un rango.
+# Escribe CSV con el tiempo, las partículas por segundo y la eficiencia de cada corrida.
+#
+# Uso: ./escalamiento_mpi.sh [pasos] [rangos] [particulas_por_rango] [hilos] > debil_mpi.csv
+#   pasos                 pasos por corrida (por defecto 200)
+#   rangos                lista de rangos separada por comas (por defecto 1,2,4,... hasta nproc)
+#   particulas_por_rango  partículas de cada ventana (por defecto 100000)
+#   hilos                 hilos de OpenMP por rango (por defecto 1)
+# Variables: DIST cambia el ejecutable, MPIRUN el lanzador (por ejemplo
+# "mpirun --oversubscribe" para más rangos que CPUs), PIN la afinidad de los hilos y EXTRA
+# agrega opciones al programa.
+
+STEPS=${1:-200}
+RANKS=${2:-}
+BASE=${3:-100000}
+THREADS=${4:-1}
+DIST=${DIST:-./dist}
+MPIRUN=${MPIRUN:-mpirun}
+PIN=${PIN:-none}
+SEED=${SEED:-1}
+EXTRA=${EXTRA:-}
+
+if [ -z "$RANKS" ]; then
+    # Potencias de 2 hasta la cantidad de CPUs dividida por los hilos, más ese máximo.
+    MAX=$(( $(nproc) / THREADS ))
+    [ "$MAX" -lt 1 ] && MAX=1
+    RANKS=""
+    for ((r = 1; r < MAX; r *= 2)); do RANKS="$RANKS$r,"; done
+    RANKS="$RANKS$MAX"
+fi
+
+if [ ! -x "$DIST" ]; then
+    echo "No se encontró $DIST. Compile distribuida.cpp como indica el README." >&2
+    exit 1
+fi
+
+# run RANGOS: línea CSV del resumen de una corrida.
+run() {
+    local r=$1
+    $MPIRUN -np "$r" "$DIST" $((BASE * r)) --wall "$r" --steps "$STEPS" --seed "$SEED" \
+        --threads "$THREADS" --pin "$PIN" --csv $EXTRA | awk -F, '/^CSV,/ { print $4 "," $7 }'
+}
+
+echo "tipo,rangos,hilos,particulas,segundos,particulas_por_segundo,eficiencia"
+
+base=""
+for r in ${RANKS//,/ }; do
+    result=$(run "$r")
+    time=${result%,*}
+    rate=${result#*,}
+    [ -z "$base" ] && base=$time
+    awk -v r="$r" -v t="$THREADS" -v n=$((BASE * r)) -v b="$base" -v p="$time" -v q="$rate" \
+        'BEGIN { printf "debil_mpi,%d,%d,%d,%s,%s,%.3f\n", r, t, n, p, q, b / p }'
+done
@@ -0,0 +1,91 @@
+#ifndef FASES_H
+#define FASES_H
+
+#include <cstdint>
+#include <omp.h>
+#include "particulas.h"
+#include "grilla.h"
+#include "aleatorio.h" // Librerías que importar
+
+//Fases del paso que comparten secuencia.cpp, paralela.cpp y distribuida.cpp. Como
+//IntegrateParticles, usan un "omp for" huérfano: dentro de una región paralela reparten el
+//trabajo entre los hilos, y fuera de ella corren en un solo hilo. Así los tres programas
+//calculan exactamente lo mismo.
+
+//ChangeColors
+//7 Parametros
+//Cambio de color aleatorio de las primeras n partículas: suma elapsed segundos a
+//color_change y, si pasó el tiempo que sortea el generador, elige un color nuevo. Lee
+//front y escribe back. El generador de la partícula i es (seed, RNG_STREAM_COLOR, ids[i],
+//step); ids es nullptr cuando la partícula i es la i del mundo completo.
+//Retorno nulo
+inline void ChangeColors(const ParticleSystem& front, ParticleSystem& back, int n, const int* ids, uint64_t seed, long long step, float elapsed) {
+    #pragma omp for schedule(static)
+    for (int i = 0; i < n; i++) {
+        //Generador de la partícula en este paso (no depende del hilo ni del rango).
+        CounterRng generator(seed, RNG_STREAM_COLOR, ids != nullptr ? ids[i] : i, step);
+
+        float colorChange = front.color_change[i] + elapsed;
+        float r = front.colorR[i], g = front.colorG[i], b = front.colorB[i];
+        if (colorChange >= generator.UniformInt(5, 10)) { // Change color every random seconds
+            r = generator.Uniform(0.0f, 1.0f);
+            g = generator.Uniform(0.0f, 1.0f);
+            b = generator.Uniform(0.0f, 1.0f);
+            colorChange = 0.0f;
+        }
+        back.colorR[i] = r;
+        back.colorG[i] = g;
+        back.colorB[i] = b;
+        back.color_change[i] = colorChange;
+    }
+}
+
+//AverageNeighborColors
+//6 Parametros
+//Promedio de color de los vecinos a menos de NEIGHBOR_RADIUS con grid ya construida y los
+//colores del frente en su orden (sortedR/G/B, de Gather). Escribe en back las partículas
+//con vecinos y con índice menor que owned; las demás de la grilla (el halo de
+//distribuida.cpp) solo se leen. El schedule es el de --schedule (schedule(runtime)).
+//Retorno los pares vecinos encontrados por este hilo (el que llama los suma)
+inline long long AverageNeighborColors(const SpatialGrid& grid, const float* sortedR, const float* sortedG, const float* sortedB,
+                                       int owned, ParticleSystem& back) {
+    const int m = static_cast<int>(grid.cellIndex.size());
+    long long pairs = 0;
+    //El costo por partícula depende de la densidad local, así que el schedule se elige al
+    //correr (--schedule).
+    #pragma omp for schedule(runtime)
+    for (int k = 0; k < m; k++) {
+        //Se recorre en el orden de la grilla: partículas seguidas comparten celdas vecinas, y
+        //las posiciones y colores de cada fila de celdas están contiguos (sortedX/Y y Gather),
+        //así el ciclo interno lee memoria seguida que sigue en caché aunque haya millones.
+        const int i = grid.cellIndex[k];
+        if (i >= owned) continue;                       // Prestada: la actualiza su rango
+        const float x = grid.sortedX[k], y = grid.sortedY[k];
+        float avgColorR = 0.0f, avgColorG = 0.0f, avgColorB = 0.0f;
+        int neighborCount = 0;
+
+        //Solo se revisan las partículas de la celda propia y las adyacentes.
+        grid.ForEachCandidateRange(x, y, [&](int begin, int end) {
+            #pragma omp simd reduction(+:avgColorR, avgColorG, avgColorB, neighborCount)
+            for (int j = begin; j < end; j++) {
+                const float dx = x - grid.sortedX[j];
+                const float dy = y - grid.sortedY[j];
+                const bool neighbor = (dx * dx + dy * dy < NEIGHBOR_RADIUS * NEIGHBOR_RADIUS) & (j != k); //Sin raíz
+                avgColorR += neighbor ? sortedR[j] : 0.0f;
+                avgColorG += neighbor ? sortedG[j] : 0.0f;
+                avgColorB += neighbor ? sortedB[j] : 0.0f;
+                neighborCount += neighbor;
+            }
+        });
+
+        if (neighborCount > 0) {
+            back.colorR[i] = avgColorR / neighborCount;
+            back.colorG[i] = avgColorG / neighborCount;
+            back.colorB[i] = avgColorB / neighborCount;
+        }
+        pairs += neighborCount;
+    }
+    return pairs;
+}
+
+#endif
@@ -0,0 +1,343 @@
+#ifndef GRABACION_H
+#define GRABACION_H
+
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include "particulas.h"
+#include "aleatorio.h"
+#include "medicion.h" // Librerías que importar
+
+//Grabación de una corrida para repetirla igual en otra compilación. Como todos los números
+//aleatorios salen de (semilla, flujo, índice, paso), no hace falta guardar las decisiones
+//del generador: basta la semilla, los parámetros y cuántos subpasos tuvo cada tanda (lo
+//único que depende del reloj real). Cada tanto se guarda además una suma del estado y el
+//tiempo que tomó simular el tramo, para comprobar la repetición y comparar el rendimiento.
+const char RECORD_MAGIC[8] = { 'P', 'A', 'R', 'T', 'G', 'R', 'A', 'B' };
+const uint32_t RECORD_VERSION = 3;
+const int CHECKSUM_CHUNK = 1 << 16;        //Floats por bloque de la suma (uno por iteración del "omp for").
+const int RECORD_PATH_BYTES = 256;
+
+struct RecordHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t collisions;      // --collisions
+    uint64_t seed;
+    uint64_t count;           // Partículas
+    uint32_t hz;              // --hz
+    uint32_t checksumEvery;   // Subpasos entre sumas
+    uint64_t startStep;       // Paso inicial (distinto de 0 con --load)
+    uint64_t numRuns;         // Entradas de SubstepRun
+    uint64_t numChecksums;    // Entradas de StepChecksum (la primera es el estado inicial)
+    float verletSkin;         // Margen de --verlet, 0 sin listas (cambia el orden de las sumas)
+    uint32_t neighborsOff;    // --no-neighbors
+    uint32_t batchSubsteps;   // --batch-substeps (solo entonces las tandas cambian el resultado)
+    uint32_t reserved;
+    char loadPath[RECORD_PATH_BYTES]; // Instantánea inicial, vacío si se crearon partículas
+};
+
+//Tandas seguidas con la misma cantidad de subpasos (codificación por corridas: en modo
+//headless toda la grabación es una sola entrada).
+struct SubstepRun {
+    uint32_t substeps;
+    uint32_t repeat;
+};
+
+struct StepChecksum {
+    uint64_t step;       // Paso del estado sumado
+    uint64_t checksum;
+    double seconds;      // Tiempo simulando desde la suma anterior (sin contar las sumas)
+};
+
+//ChecksumChunks
+//1 Parametro
+//Cantidad de bloques en que se divide el estado de count partículas para sumarlo.
+//Retorno la cantidad de bloques
+inline int ChecksumChunks(int count) {
+    return ParticleSystem::NUM_COLUMNS * ((count + CHECKSUM_CHUNK - 1) / CHECKSUM_CHUNK);
+}
+
+//HashChunks
+//2 Parametros
+//Suma FNV-1a de los bits de cada bloque de CHECKSUM_CHUNK floats de cada columna (solo las
+//count partículas, sin el relleno). Es un "omp for" huérfano: con un equipo cada hilo suma
+//bloques distintos.
+//Retorno nulo
+inline void HashChunks(const ParticleSystem& p, uint64_t* hashes) {
+    const int perColumn = (p.count + CHECKSUM_CHUNK - 1) / CHECKSUM_CHUNK;
+    #pragma omp for schedule(static)
+    for (int c = 0; c < ParticleSystem::NUM_COLUMNS * perColumn; c++) {
+        const float* column = p.*ParticleSystem::COLUMNS[c / perColumn];
+        const int begin = (c % perColumn) * CHECKSUM_CHUNK;
+        const int end = std::min(begin + CHECKSUM_CHUNK, p.count);
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (int i = begin; i < end; i++) {
+            uint32_t bits;
+            std::memcpy(&bits, &column[i], sizeof(bits));
+            hash = (hash ^ bits) * 0x100000001B3ull;
+        }
+        hashes[c] = hash;
+    }
+}
+
+//CombineChunks
+//3 Parametros
+//Junta las sumas de los bloques, siempre en el mismo orden, con el paso del estado.
+//Retorno la suma del estado, igual con cualquier cantidad de hilos
+inline uint64_t CombineChunks(const uint64_t* hashes, int chunks, long long step) {
+    uint64_t checksum = Mix64(static_cast<uint64_t>(step));
+    for (int c = 0; c < chunks; c++) {
+        checksum = Mix64(checksum ^ hashes[c]);
+    }
+    return checksum;
+}
+
+//Grabación en memoria. El programa llama Begin() con los parámetros, AddChecksum() con el
+//estado inicial, AddBatch() después de cada tanda y Write() al terminar; Read() carga una
+//grabación para RunReplay().
+struct RunRecord {
+    RecordHeader header = {};
+    std::vector<SubstepRun> runs;
+    std::vector<StepChecksum> checksums;
+    std::vector<uint64_t> chunkHashes;   // Espacio de trabajo de la suma
+    long long steps = 0;                 // Tandas grabadas
+    long long substeps = 0;              // Subpasos simulados en esas tandas
+    double intervalSeconds = 0.0;        // Tiempo simulando desde la última suma
+
+    //Begin
+    //9 Parametros
+    //Empieza una grabación con los parámetros de la corrida.
+    //Retorno nulo
+    void Begin(uint64_t seed, int count, int hz, bool collisions, float verletSkin, bool neighbors, bool batchSubsteps, int every, const char* loadPath) {
+        header = {};
+        std::memcpy(header.magic, RECORD_MAGIC, sizeof(header.magic));
+        header.version = RECORD_VERSION;
+        header.collisions = collisions ? 1 : 0;
+        header.verletSkin = verletSkin;
+        header.neighborsOff = neighbors ? 0 : 1;
+        header.batchSubsteps = batchSubsteps ? 1 : 0;
+        header.seed = seed;
+        header.count = static_cast<uint64_t>(count);
+        header.hz = static_cast<uint32_t>(hz);
+        header.checksumEvery = static_cast<uint32_t>(every);
+        if (loadPath != nullptr) std::snprintf(header.loadPath, sizeof(header.loadPath), "%s", loadPath);
+        runs.clear();
+        checksums.clear();
+        runs.reserve(1024);
+        checksums.reserve(1024);
+        chunkHashes.assign(ChecksumChunks(count), 0);
+        steps = 0;
+        substeps = 0;
+        intervalSeconds = 0.0;
+    }
+
+    bool Active() const { return header.version != 0; }
+
+    //AddBatch
+    //2 Parametros
+    //Agrega una tanda de batchSubsteps subpasos que tomó seconds segundos. Las sumas van cada
+    //checksumEvery subpasos simulados, no cada tantas tandas: como solo se puede sumar entre
+    //tandas, toca sumar en la tanda que llega o pasa un múltiplo de checksumEvery.
+    //Retorno verdadero si después de esta tanda toca guardar una suma (AddChecksum)
+    bool AddBatch(int batchSubsteps, double seconds) {
+        const uint32_t value = static_cast<uint32_t>(batchSubsteps);
+        if (!runs.empty() && runs.back().substeps == value && runs.back().repeat < UINT32_MAX) {
+            runs.back().repeat++;
+        } else {
+            runs.push_back(SubstepRun{ value, 1 });
+        }
+        steps++;
+        intervalSeconds += seconds;
+        const long long before = substeps;
+        substeps += batchSubsteps;
+        return substeps / header.checksumEvery > before / header.checksumEvery;
+    }
+
+    //AddChecksum
+    //2 Parametros
+    //Guarda la suma del estado en el paso dado con el tiempo del tramo (la primera es la del
+    //estado inicial).
+    //Retorno nulo
+    void AddChecksum(long long step, uint64_t checksum) {
+        checksums.push_back(StepChecksum{ static_cast<uint64_t>(step), checksum, intervalSeconds });
+        intervalSeconds = 0.0;
+    }
+
+    //NeedsFinalChecksum
+    //1 Parametro
+    //Indica si el último estado (paso step) todavía no tiene su suma.
+    //Retorno verdadero si falta
+    bool NeedsFinalChecksum(long long step) const {
+        return checksums.empty() || checksums.back().step != static_cast<uint64_t>(step);
+    }
+
+    //Write
+    //1 Parametro
+    //Escribe la grabación: encabezado, tandas y sumas.
+    //Retorno verdadero si se pudo escribir
+    bool Write(const char* path) {
+        header.startStep = checksums.empty() ? 0 : checksums.front().step;
+        header.numRuns = runs.size();
+        header.numChecksums = checksums.size();
+        std::FILE* file = std::fopen(path, "wb");
+        if (file == nullptr) return false;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && std::fwrite(runs.data(), sizeof(SubstepRun), runs.size(), file) == runs.size();
+        ok = ok && std::fwrite(checksums.data(), sizeof(StepChecksum), checksums.size(), file) == checksums.size();
+        return (std::fclose(file) == 0) && ok;
+    }
+
+    //Read
+    //1 Parametro
+    //Lee y valida una grabación.
+    //Retorno verdadero si el archivo es válido
+    bool Read(const char* path) {
+        std::FILE* file = std::fopen(path, "rb");
+        if (file == nullptr) return false;
+        bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+                  && std::memcmp(header.magic, RECORD_MAGIC, sizeof(header.magic)) == 0
+                  && header.version == RECORD_VERSION && header.count <= static_cast<uint64_t>(INT32_MAX)
+                  && header.hz > 0 && header.checksumEvery > 0 && header.numChecksums > 0
+                  && header.numRuns < (1ull << 32) && header.numChecksums < (1ull << 32);
+        if (ok) {
+            header.loadPath[RECORD_PATH_BYTES - 1] = '\0';
+            runs.resize(header.numRuns);
+            checksums.resize(header.numChecksums);
+            chunkHashes.assign(ChecksumChunks(static_cast<int>(header.count)), 0);
+            ok = std::fread(runs.data(), sizeof(SubstepRun), runs.size(), file) == runs.size()
+                 && std::fread(checksums.data(), sizeof(StepChecksum), checksums.size(), file) == checksums.size();
+        }
+        std::fclose(file);
+        if (!ok) header = {};
+        return ok;
+    }
+};
+
+//VerifyChecksumSpacing
+//0 Parametros
+//Prueba de --verify: graba tandas de 1 a 4 subpasos con una suma cada 4 subpasos y
+//revisa que AddBatch pida la suma justo en las tandas que llegan o pasan un múltiplo de 4,
+//y que haya una por cada múltiplo (ninguna tanda pasa dos a la vez).
+//Retorno 0 si las sumas quedan donde corresponde, 1 si no
+inline int VerifyChecksumSpacing() {
+    const int every = 4;
+    const int sizes[] = { 1, 2, 3, 1, 1, 3, 2, 4, 1 };
+    RunRecord record;
+    record.Begin(0, 1, 60, false, 0.0f, true, false, every, nullptr);
+    long long step = 0;
+    int due = 0;
+    int wrong = 0;
+    for (int round = 0; round < 100; round++) {
+        for (int batch : sizes) {
+            const bool expected = (step + batch) / every > step / every;
+            step += batch;
+            const bool actual = record.AddBatch(batch, 0.0);
+            due += actual;
+            wrong += actual != expected;
+        }
+    }
+    if (wrong > 0 || due != step / every) {
+        std::cout << "Verificación FALLIDA: " << wrong << " tandas con la suma fuera de lugar (" << due << " sumas en "
+                  << step << " subpasos, cada " << every << ").\n";
+        return 1;
+    }
+    std::cout << "Verificación correcta: " << due << " sumas cada " << every << " subpasos en " << record.steps
+              << " tandas de 1 a 4 subpasos.\n";
+    return 0;
+}
+
+//RunReplay
+//5 Parametros
+//Repite una grabación sin ventana: crea el estado inicial, simula las mismas tandas con el
+//mismo paso y, donde la grabación tiene una suma, compara la del estado actual e imprime el
+//tiempo por paso del tramo junto al grabado. Las sumas no cuentan en los tiempos. Con csv
+//imprime al final la misma línea "CSV,..." que RunHeadless.
+//Retorno 0 si todas las sumas coinciden, 1 si alguna es distinta
+inline int RunReplay(RunRecord& record, void (*create)(), void (*step)(float, int), uint64_t (*checksum)(), bool csv) {
+    const float deltaTime = 1.0f / record.header.hz;
+    long long totalSteps = 0;
+    for (const SubstepRun& run : record.runs) totalSteps += run.repeat;
+    std::vector<double> latencies;
+    latencies.reserve(totalSteps);
+
+    std::cout << "Repitiendo " << record.header.count << " partículas, semilla " << record.header.seed << ", "
+              << record.header.hz << " Hz" << (record.header.collisions ? ", con choques" : "")
+              << (record.header.verletSkin > 0.0f ? ", con listas de Verlet" : "")
+              << (record.header.neighborsOff ? ", sin vecinos" : "")
+              << (record.header.batchSubsteps ? ", una pasada por tanda" : "")
+              << ", " << totalSteps << " tandas\n";
+    create();
+    int mismatches = 0;
+    int matches = 0;
+    size_t nextChecksum = 0;
+    long long currentStep = static_cast<long long>(record.header.startStep);
+    double intervalSeconds = 0.0;
+    double recordedSeconds = 0.0;
+
+    std::cout << std::fixed;
+    auto compare = [&]() {
+        const StepChecksum& expected = record.checksums[nextChecksum++];
+        const uint64_t actual = checksum();
+        const bool same = actual == expected.checksum;
+        mismatches += !same;
+        matches += same;
+        recordedSeconds += expected.seconds;
+        std::cout << "  paso " << currentStep;
+        if (nextChecksum > 1) {
+            const long long stepsInInterval = static_cast<long long>(expected.step - record.checksums[nextChecksum - 2].step);
+            std::cout << std::setprecision(3) << ": " << intervalSeconds / stepsInInterval * 1e3 << " ms/paso (grabado "
+                      << expected.seconds / stepsInInterval * 1e3 << ", " << std::setprecision(2)
+                      << (intervalSeconds > 0.0 ? expected.seconds / intervalSeconds : 0.0) << "x)";
+        }
+        std::cout << " suma " << std::hex << std::setw(16) << std::setfill('0') << actual << std::dec << std::setfill(' ')
+                  << (same ? " igual" : " DISTINTA") << "\n";
+        intervalSeconds = 0.0;
+    };
+
+    compare(); //Estado inicial
+    double loopTime = 0.0;
+    for (const SubstepRun& run : record.runs) {
+        for (uint32_t r = 0; r < run.repeat; r++) {
+            Clock::time_point stepStart = Clock::now();
+            step(deltaTime, static_cast<int>(run.substeps));
+            const double seconds = std::chrono::duration<double>(Clock::now() - stepStart).count();
+            latencies.push_back(seconds);
+            intervalSeconds += seconds;
+            loopTime += seconds;
+            currentStep += run.substeps; //El paso cuenta subpasos
+            if (nextChecksum < record.checksums.size() && record.checksums[nextChecksum].step == static_cast<uint64_t>(currentStep)) {
+                compare();
+            }
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::setprecision(3);
+    std::cout << "Tiempo simulando: " << loopTime * 1e3 << " ms (grabado " << recordedSeconds * 1e3 << " ms)\n";
+    if (!latencies.empty()) {
+        std::cout << "Latencia por tanda (ms): p50 " << Percentile(latencies, 50) * 1e3
+                  << "  p90 " << Percentile(latencies, 90) * 1e3
+                  << "  p99 " << Percentile(latencies, 99) * 1e3
+                  << "  max " << latencies.back() * 1e3 << "\n";
+    }
+    if (nextChecksum < record.checksums.size()) {
+        std::cout << "La grabación tiene " << record.checksums.size() - nextChecksum << " sumas que no se alcanzaron.\n";
+        mismatches++;
+    }
+    std::cout << (mismatches == 0 ? "Repetición idéntica" : "Repetición DISTINTA") << ": "
+              << matches << " de " << record.checksums.size() << " sumas iguales\n";
+    if (csv && !latencies.empty()) {
+        //particulas,pasos,segundos,p50_ms,p99_ms,particulas_por_segundo
+        std::cout << std::setprecision(6) << "CSV," << record.header.count << "," << totalSteps << "," << loopTime << ","
+                  << Percentile(latencies, 50) * 1e3 << "," << Percentile(latencies, 99) * 1e3 << ","
+                  << std::setprecision(0) << static_cast<double>(record.header.count) * totalSteps / loopTime << "\n";
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+
+#endif
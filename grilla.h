@@ -0,0 +1,167 @@
+#ifndef GRILLA_H
+#define GRILLA_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <omp.h> // Librerías que importar
+
+const float NEIGHBOR_RADIUS = 30.0f; //Radio en el que se promedian los colores vecinos.
+
+//Grilla uniforme (cell list) que se reconstruye en cada paso. El tamaño de celda es igual
+//al radio de búsqueda (el de vecinos o el diámetro de choque), por lo que los vecinos de
+//una partícula solo pueden estar en su celda o en las 8 celdas adyacentes.
+struct SpatialGrid {
+    float cellSize = NEIGHBOR_RADIUS;
+    float minX = 0.0f;
+    float minY = 0.0f;
+    int cellsX = 0;
+    int cellsY = 0;
+
+    std::vector<int> cellStart;    // Inicio de cada celda dentro de cellIndex (numCells + 1)
+    std::vector<int> cellIndex;    // Índices de partículas ordenados por celda
+    std::vector<int> particleCell; // Celda de cada partícula
+    std::vector<float> sortedX;    // Posiciones en el orden de cellIndex (contiguas por celda)
+    std::vector<float> sortedY;
+    std::vector<int> threadOffset; // Histograma / desplazamientos por hilo y celda
+
+    //Init
+    //5 Parametros
+    //Ajusta la grilla al mundo [minX, minX + width] x [minY, minY + height] con celdas de size
+    //Retorno nulo
+    void Init(float worldMinX, float worldMinY, float width, float height, float size = NEIGHBOR_RADIUS) {
+        cellSize = size;
+        minX = worldMinX;
+        minY = worldMinY;
+        cellsX = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+        cellsY = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+        cellStart.assign(cellsX * cellsY + 1, 0);
+    }
+
+    int NumCells() const { return cellsX * cellsY; }
+
+    //Las posiciones fuera del mundo se asignan a la celda del borde, lo que mantiene
+    //la propiedad de que dos puntos a menos de cellSize quedan en celdas adyacentes.
+    int CellX(float x) const {
+        int cx = static_cast<int>((x - minX) / cellSize);
+        return std::min(std::max(cx, 0), cellsX - 1);
+    }
+    int CellY(float y) const {
+        int cy = static_cast<int>((y - minY) / cellSize);
+        return std::min(std::max(cy, 0), cellsY - 1);
+    }
+
+    //Build
+    //3 Parametros
+    //Ordena las partículas por celda con un counting sort y deja sus posiciones en ese
+    //orden. Debe llamarse desde todos los hilos del equipo (o fuera de una región
+    //paralela, donde corre con un solo hilo).
+    //Cada hilo cuenta y reparte un bloque contiguo, así el orden dentro de cada celda es
+    //siempre ascendente sin importar la cantidad de hilos.
+    //Retorno nulo
+    void Build(const float* posX, const float* posY, int n) {
+        const int numCells = NumCells();
+        const int tid = omp_get_thread_num();
+        const int numThreads = omp_get_num_threads();
+
+        #pragma omp single
+        {
+            threadOffset.assign(static_cast<size_t>(numThreads) * numCells, 0);
+            particleCell.resize(n);
+            cellIndex.resize(n);
+            sortedX.resize(n);
+            sortedY.resize(n);
+        }
+
+        const int begin = static_cast<int>(static_cast<long long>(n) * tid / numThreads);
+        const int end = static_cast<int>(static_cast<long long>(n) * (tid + 1) / numThreads);
+        int* offset = &threadOffset[static_cast<size_t>(tid) * numCells];
+
+        //Conteo de partículas por celda en el bloque de este hilo.
+        for (int i = begin; i < end; i++) {
+            int c = CellY(posY[i]) * cellsX + CellX(posX[i]);
+            particleCell[i] = c;
+            offset[c]++;
+        }
+        #pragma omp barrier
+
+        //Suma prefija por (celda, hilo) para obtener dónde escribe cada hilo.
+        #pragma omp single
+        {
+            int sum = 0;
+            for (int c = 0; c < numCells; c++) {
+                cellStart[c] = sum;
+                for (int t = 0; t < numThreads; t++) {
+                    int count = threadOffset[static_cast<size_t>(t) * numCells + c];
+                    threadOffset[static_cast<size_t>(t) * numCells + c] = sum;
+                    sum += count;
+                }
+            }
+            cellStart[numCells] = sum;
+        }
+
+        //Reparto de los índices a su celda.
+        for (int i = begin; i < end; i++) {
+            const int k = offset[particleCell[i]]++;
+            cellIndex[k] = i;
+            sortedX[k] = posX[i];
+            sortedY[k] = posY[i];
+        }
+        #pragma omp barrier
+    }
+
+    //Gather
+    //2 Parametros
+    //Copia values en el orden de la grilla (out[k] = values[cellIndex[k]]), para que los
+    //ciclos por celda lean memoria contigua. "omp for" huérfano, como Build.
+    //Retorno nulo
+    void Gather(const float* values, float* out) const {
+        const int n = static_cast<int>(cellIndex.size());
+        #pragma omp for schedule(static)
+        for (int k = 0; k < n; k++) {
+            out[k] = values[cellIndex[k]];
+        }
+    }
+
+    //ForEachCandidate
+    //3 Parametros
+    //Llama fn(j) para cada partícula en la celda de (x, y) y sus celdas adyacentes.
+    //Retorno nulo
+    template <typename Fn>
+    void ForEachCandidate(float x, float y, Fn fn) const {
+        const int cx = CellX(x);
+        const int cy = CellY(y);
+        const int x0 = std::max(cx - 1, 0), x1 = std::min(cx + 1, cellsX - 1);
+        const int y0 = std::max(cy - 1, 0), y1 = std::min(cy + 1, cellsY - 1);
+
+        for (int gy = y0; gy <= y1; gy++) {
+            for (int gx = x0; gx <= x1; gx++) {
+                const int c = gy * cellsX + gx;
+                for (int k = cellStart[c]; k < cellStart[c + 1]; k++) {
+                    fn(cellIndex[k]);
+                }
+            }
+        }
+    }
+
+    //ForEachCandidateRange
+    //3 Parametros
+    //Llama fn(begin, end) con el rango [begin, end) del orden de la grilla de la celda de
+    //(x, y) y de cada celda adyacente; sirve para recorrer sortedX/sortedY y los arreglos
+    //de Gather de forma contigua.
+    //Retorno nulo
+    template <typename Fn>
+    void ForEachCandidateRange(float x, float y, Fn fn) const {
+        const int cx = CellX(x);
+        const int cy = CellY(y);
+        const int x0 = std::max(cx - 1, 0), x1 = std::min(cx + 1, cellsX - 1);
+        const int y0 = std::max(cy - 1, 0), y1 = std::min(cy + 1, cellsY - 1);
+
+        for (int gy = y0; gy <= y1; gy++) {
+            //Las celdas x0..x1 de una fila son consecutivas en cellIndex: un solo rango.
+            fn(cellStart[gy * cellsX + x0], cellStart[gy * cellsX + x1 + 1]);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef INSTANTANEA_H
+#define INSTANTANEA_H
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "particulas.h" // Librerías que importar
+
+//Formato de las instantáneas: un encabezado de SNAPSHOT_HEADER_BYTES (una página) y
+//después las columnas de ParticleSystem en el orden de COLUMNS, cada una de stride
+//floats. Como las columnas empiezan alineadas a página y a 64 bytes, el archivo se puede
+//mapear y usar directamente como arreglos de partículas, sin copiar.
+const char SNAPSHOT_MAGIC[8] = { 'P', 'A', 'R', 'T', 'S', 'N', 'A', 'P' };
+const uint32_t SNAPSHOT_VERSION = 1;
+const size_t SNAPSHOT_HEADER_BYTES = 4096;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t columns;     // ParticleSystem::NUM_COLUMNS al guardar
+    uint64_t count;       // Partículas
+    uint64_t stride;      // Floats por columna
+    uint64_t step;        // Paso de la simulación (contador del generador aleatorio)
+    uint64_t seed;        // Semilla de la corrida
+    double time;          // Segundos simulados
+    double batchTime;
+};
+static_assert(sizeof(SnapshotHeader) <= SNAPSHOT_HEADER_BYTES, "El encabezado debe caber en una página");
+
+//SnapshotBytes
+//1 Parametro
+//Tamaño del archivo para un sistema de partículas.
+//Retorno los bytes
+inline size_t SnapshotBytes(const ParticleSystem& particles) {
+    return SNAPSHOT_HEADER_BYTES + particles.stride * ParticleSystem::NUM_COLUMNS * sizeof(float);
+}
+
+//SnapshotTemporaryPath
+//1 Parametro
+//Nombre del archivo temporal de WriteSnapshot para path. Se arma una vez al preparar la
+//escritura, así guardar cada instantánea no reserva memoria.
+//Retorno path con ".tmp" al final
+inline std::string SnapshotTemporaryPath(const char* path) {
+    return std::string(path) + ".tmp";
+}
+
+//WriteSnapshot
+//5 Parametros
+//Guarda particles en path: crea el archivo temporal (temporary, de SnapshotTemporaryPath)
+//del tamaño final, lo mapea, copia el encabezado y las columnas y lo renombra a path, así
+//una instantánea anterior nunca queda a medio escribir.
+//Retorno verdadero si se pudo guardar
+inline bool WriteSnapshot(const char* path, const char* temporary, const ParticleSystem& particles, uint64_t step, uint64_t seed) {
+    const size_t bytes = SnapshotBytes(particles);
+    const int fd = open(temporary, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.columns = ParticleSystem::NUM_COLUMNS;
+    header.count = static_cast<uint64_t>(particles.count);
+    header.stride = particles.stride;
+    header.step = step;
+    header.seed = seed;
+    header.time = particles.time;
+    header.batchTime = particles.batchTime;
+    std::memcpy(mapping, &header, sizeof(header));
+
+    char* columns = static_cast<char*>(mapping) + SNAPSHOT_HEADER_BYTES;
+    for (int k = 0; k < ParticleSystem::NUM_COLUMNS; k++) {
+        std::memcpy(columns + k * particles.stride * sizeof(float), particles.*ParticleSystem::COLUMNS[k], particles.stride * sizeof(float));
+    }
+    const bool synced = msync(mapping, bytes, MS_SYNC) == 0;
+    munmap(mapping, bytes);
+    return synced && std::rename(temporary, path) == 0;
+}
+
+//ReadSnapshotHeader
+//2 Parametros
+//Lee y valida el encabezado de una instantánea (marca, versión, columnas y tamaño).
+//Retorno verdadero si el archivo es válido
+inline bool ReadSnapshotHeader(const char* path, SnapshotHeader& header) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    const bool ok = fstat(fd, &info) == 0 && pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    close(fd);
+    if (!ok) return false;
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) return false;
+    if (header.version != SNAPSHOT_VERSION || header.columns != static_cast<uint32_t>(ParticleSystem::NUM_COLUMNS)) return false;
+    if (header.count > static_cast<uint64_t>(INT32_MAX) || header.stride < header.count) return false;
+    return static_cast<uint64_t>(info.st_size) >= SNAPSHOT_HEADER_BYTES + header.stride * ParticleSystem::NUM_COLUMNS * sizeof(float);
+}
+
+//LoadSnapshot
+//3 Parametros
+//Mapea la instantánea de path (MAP_PRIVATE) y apunta las columnas de particles al archivo,
+//sin copiar: las páginas se leen del disco (o del caché del sistema) cuando se usan, y las
+//escrituras de la simulación quedan en copias privadas sin tocar el archivo. particles
+//debe tener la misma cantidad de partículas que el archivo; header queda con el encabezado.
+//Retorno verdadero si se pudo cargar
+inline bool LoadSnapshot(const char* path, ParticleSystem& particles, SnapshotHeader& header) {
+    if (!ReadSnapshotHeader(path, header) || header.count != static_cast<uint64_t>(particles.count) || header.stride != particles.stride) {
+        return false;
+    }
+    const size_t bytes = SNAPSHOT_HEADER_BYTES + header.stride * ParticleSystem::NUM_COLUMNS * sizeof(float);
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    particles.Adopt(mapping, bytes, SNAPSHOT_HEADER_BYTES);
+    particles.time = header.time;
+    particles.batchTime = header.batchTime;
+    return true;
+}
+
+//Guardado periódico en segundo plano. El hilo que simula copia el estado a staging (con
+//CopyParticles, en paralelo si está en una región paralela) y llama Commit(); un hilo
+//aparte escribe el archivo mientras la simulación sigue. Si la escritura anterior no ha
+//terminado, la instantánea de ese paso se omite en vez de detener la simulación.
+struct Checkpointer {
+    ParticleSystem staging;
+    const char* path = nullptr;
+    std::string temporaryPath;          // Archivo temporal de WriteSnapshot, armado en Start
+    int every = 1;
+    uint64_t seed = 0;
+    uint64_t step = 0;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool pending = false;
+    bool stop = false;
+    std::atomic<bool> busy{false};
+
+    Checkpointer() = default;
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+    ~Checkpointer() { Stop(); }
+
+    bool Enabled() const { return path != nullptr; }
+
+    //Start
+    //4 Parametros
+    //Reserva la copia para n partículas y arranca el hilo que escribe en file cada
+    //everySteps pasos.
+    //Retorno nulo
+    void Start(const char* file, int n, int everySteps, uint64_t runSeed) {
+        path = file;
+        temporaryPath = SnapshotTemporaryPath(file);
+        every = everySteps;
+        seed = runSeed;
+        staging.Allocate(n);
+        worker = std::thread([this] { Run(); });
+    }
+
+    //Due
+    //2 Parametros
+    //Indica si la tanda de substeps pasos que terminó en currentStep pasó por un múltiplo de
+    //every y el hilo de escritura está libre.
+    //Retorno verdadero si hay que copiar el estado a staging
+    bool Due(long long currentStep, int substeps) const {
+        return Enabled() && currentStep > 0 && currentStep / every > (currentStep - substeps) / every
+               && !busy.load(std::memory_order_acquire);
+    }
+
+    //Commit
+    //1 Parametro
+    //Entrega staging (ya copiado) al hilo de escritura.
+    //Retorno nulo
+    void Commit(long long currentStep) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            step = static_cast<uint64_t>(currentStep);
+            pending = true;
+            busy.store(true, std::memory_order_release);
+        }
+        wake.notify_one();
+    }
+
+    //Run
+    //0 Parametros
+    //Cuerpo del hilo de escritura.
+    //Retorno nulo
+    void Run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return pending || stop; });
+            if (!pending) return;
+            lock.unlock();
+            if (!WriteSnapshot(path, temporaryPath.c_str(), staging, step, seed)) {
+                std::cout << "No se pudo guardar la instantánea en " << path << "\n";
+            }
+            lock.lock();
+            pending = false;
+            busy.store(false, std::memory_order_release);
+        }
+    }
+
+    //Finish
+    //2 Parametros
+    //Al terminar la corrida: espera la escritura en curso y guarda el estado final.
+    //Retorno nulo
+    void Finish(const ParticleSystem& state, long long currentStep) {
+        if (!Enabled()) return;
+        Stop();
+        if (WriteSnapshot(path, temporaryPath.c_str(), state, static_cast<uint64_t>(currentStep), seed)) {
+            std::cout << "Instantánea final (paso " << currentStep << ") en " << path << "\n";
+        } else {
+            std::cout << "No se pudo guardar la instantánea en " << path << "\n";
+        }
+    }
+
+    //Stop
+    //0 Parametros
+    //Termina la escritura pendiente y detiene el hilo.
+    //Retorno nulo
+    void Stop() {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+};
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef MEDICION_H
+#define MEDICION_H
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include "perfil.h"
+#include "politicas.h"
+#include "memoria.h" // Librerías que importar
+
+typedef std::chrono::high_resolution_clock Clock;
+
+//Acumula el tiempo de cada fase. Start() marca el inicio del paso y Lap(fase) suma el
+//tiempo transcurrido desde la marca anterior a esa fase. Solo lo usa un hilo a la vez.
+struct PhaseTimer {
+    double total[NUM_PHASES] = {};
+    Clock::time_point mark;
+
+    void Start() { mark = Clock::now(); }
+
+    void Lap(Phase phase) {
+        Clock::time_point now = Clock::now();
+        total[phase] += std::chrono::duration<double>(now - mark).count();
+        mark = now;
+    }
+
+    void Reset() { std::fill(total, total + NUM_PHASES, 0.0); }
+};
+
+PhaseTimer phaseTimer; //Tiempos por fase del paso actual y los anteriores.
+long long neighborPairs = 0; //Pares vecinos encontrados (suma de todos los pasos).
+long long collisionContacts = 0; //Choques resueltos con --collisions (suma de todos los pasos).
+
+//Percentile
+//2 Parametros
+//Percentil p (0 a 100) de un arreglo ya ordenado.
+//Retorno el valor del percentil
+inline double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t k = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(k, sorted.size() - 1)];
+}
+
+//RunHeadless
+//6 Parametros
+//Corre la simulación sin GLUT ni OpenGL, tan rápido como se pueda, y reporta la latencia
+//por paso (percentiles), partículas actualizadas por segundo y el tiempo de cada fase
+//(también las de dibujo si el paso dibuja, como con --offscreen).
+//Cada paso simula deltaTime segundos, el mismo paso fijo que usa la ventana.
+//Con csv imprime además una línea "CSV,..." para escalamiento.sh.
+//Cuenta las reservas del heap (memoria.h) del primer paso, que dimensiona los arreglos que
+//solo crecen, y las de los siguientes, que deberían ser cero.
+//Retorno las reservas de los pasos después del primero
+inline long long RunHeadless(int numParticles, int steps, float deltaTime, void (*create)(), void (*step)(float), bool csv) {
+    std::vector<double> latencies(steps);
+
+    Clock::time_point startTime = Clock::now();
+    create();
+    double creationTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    phaseTimer.Reset();
+    neighborPairs = 0;
+    collisionContacts = 0;
+    const long long allocationsBefore = HeapAllocations();
+    long long allocationsFirst = 0;
+    Clock::time_point loopStart = Clock::now();
+    for (int s = 0; s < steps; s++) {
+        Clock::time_point stepStart = Clock::now();
+        step(deltaTime);
+        latencies[s] = std::chrono::duration<double>(Clock::now() - stepStart).count();
+        if (s == 0) allocationsFirst = HeapAllocations();
+    }
+    double loopTime = std::chrono::duration<double>(Clock::now() - loopStart).count();
+    const long long steadyAllocations = HeapAllocations() - allocationsFirst;
+
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Partículas: " << numParticles << ", pasos: " << steps << "\n";
+    std::cout << "Creación: " << creationTime * 1e3 << " ms\n";
+    std::cout << "Tiempo total: " << loopTime * 1e3 << " ms\n";
+    std::cout << "Latencia por paso (ms): p50 " << Percentile(latencies, 50) * 1e3
+              << "  p90 " << Percentile(latencies, 90) * 1e3
+              << "  p99 " << Percentile(latencies, 99) * 1e3
+              << "  max " << latencies.back() * 1e3 << "\n";
+    std::cout << "Partículas actualizadas por segundo: " << std::setprecision(0)
+              << static_cast<double>(numParticles) * steps / loopTime << "\n";
+    std::cout << std::setprecision(3);
+    const double particleSteps = static_cast<double>(numParticles) * steps; //0 con 0 partículas: sin promedio
+    std::cout << "Vecinos promedio por partícula: " << (particleSteps > 0.0 ? neighborPairs / particleSteps : 0.0) << "\n";
+    if (collisionContacts > 0) {
+        std::cout << "Choques por paso: " << static_cast<double>(collisionContacts) / steps << "\n";
+    }
+    std::cout << "Reservas de memoria: " << allocationsFirst - allocationsBefore << " en el primer paso, "
+              << steadyAllocations << " en los " << steps - 1 << " siguientes\n";
+    for (int p = 0; p < NUM_PHASES; p++) {
+        if ((p >= NUM_SIM_PHASES || p == PHASE_COLLISIONS) && phaseTimer.total[p] == 0.0) continue; //Choques solo con --collisions, dibujo solo con --offscreen
+        std::cout << "  " << PHASE_NAMES[p] << ": " << phaseTimer.total[p] * 1e3 << " ms ("
+                  << phaseTimer.total[p] / steps * 1e3 << " ms/paso)\n";
+    }
+    if (csv) {
+        //particulas,pasos,segundos,p50_ms,p99_ms,particulas_por_segundo
+        std::cout << std::setprecision(6) << "CSV," << numParticles << "," << steps << "," << loopTime << ","
+                  << Percentile(latencies, 50) * 1e3 << "," << Percentile(latencies, 99) * 1e3 << ","
+                  << std::setprecision(0) << static_cast<double>(numParticles) * steps / loopTime << "\n";
+    }
+    return steadyAllocations;
+}
+
+//CheckSteadyAllocations
+//1 Parametro
+//Para --check-alloc: reporta si los pasos después del primero reservaron memoria del heap.
+//Sirve de prueba para que ningún cambio vuelva a reservar memoria en cada frame.
+//Retorno 0 si no hubo reservas, 1 si las hubo
+inline int CheckSteadyAllocations(long long allocations) {
+    if (allocations > 0) {
+        std::cout << "Falla: " << allocations << " reservas de memoria después del primer paso.\n";
+        return 1;
+    }
+    std::cout << "Sin reservas de memoria después del primer paso.\n";
+    return 0;
+}
+
+//RunKernelBenchmark
+//6 Parametros
+//Mide cada combinación de fases (politicas.h): prepare(k) elige la combinación k y crea el
+//mismo estado inicial, y luego se corren steps pasos con step. Reporta la latencia por paso
+//y las partículas por segundo de cada una, y cuánto rinde frente a la primera (grilla).
+//Con csv imprime además una línea "CSV,..." por combinación, con su nombre al final.
+//Retorno nulo
+inline void RunKernelBenchmark(int numParticles, int steps, void (*prepare)(int), void (*step)(float), float deltaTime, bool csv) {
+    std::vector<double> latencies(steps);
+    double baseline = 0.0;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Partículas: " << numParticles << ", pasos por combinación: " << steps << "\n";
+    for (int k = 0; k < NUM_STEP_KERNELS; k++) {
+        prepare(k);
+        Clock::time_point loopStart = Clock::now();
+        for (int s = 0; s < steps; s++) {
+            Clock::time_point stepStart = Clock::now();
+            step(deltaTime);
+            latencies[s] = std::chrono::duration<double>(Clock::now() - stepStart).count();
+        }
+        const double loopTime = std::chrono::duration<double>(Clock::now() - loopStart).count();
+        const double rate = static_cast<double>(numParticles) * steps / loopTime;
+        if (k == 0) baseline = rate;
+        std::sort(latencies.begin(), latencies.end());
+
+        std::cout << "  " << std::left << std::setw(24) << KernelName(k) << std::right
+                  << "p50 " << std::setw(9) << Percentile(latencies, 50) * 1e3 << " ms  p99 " << std::setw(9) << Percentile(latencies, 99) * 1e3
+                  << " ms  " << std::setprecision(0) << std::setw(12) << rate << " partículas/s  "
+                  << std::setprecision(2) << (baseline > 0.0 ? rate / baseline : 0.0) << "x\n" << std::setprecision(3);
+        if (csv) {
+            //particulas,pasos,segundos,p50_ms,p99_ms,particulas_por_segundo,combinacion
+            std::cout << std::setprecision(6) << "CSV," << numParticles << "," << steps << "," << loopTime << ","
+                      << Percentile(latencies, 50) * 1e3 << "," << Percentile(latencies, 99) * 1e3 << ","
+                      << std::setprecision(0) << rate << "," << KernelName(k) << "\n" << std::setprecision(3);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <atomic>
+#include <cstdlib>
+#include <new> // Librerías que importar
+
+//Contador de reservas del heap. Reemplaza operator new y delete globales, así que cada
+//std::vector, std::string o new del programa (y de las librerías de C++) pasa por aquí.
+//Las reservas de malloc directas (OpenMP, GLUT) no se cuentan. Como define funciones
+//globales no puede estar en dos archivos .cpp del mismo programa; lo incluye medicion.h y
+//cada programa es un solo archivo .cpp.
+std::atomic<long long> heapAllocations{0};  // Reservas desde el inicio
+std::atomic<long long> heapBytes{0};        // Bytes pedidos desde el inicio
+
+//HeapAllocations
+//0 Parametros
+//Cantidad de reservas hechas hasta ahora; la diferencia entre dos lecturas es lo que se
+//reservó entre ellas.
+//Retorno la cantidad de reservas
+inline long long HeapAllocations() {
+    return heapAllocations.load(std::memory_order_relaxed);
+}
+
+//CountedAllocate
+//2 Parametros
+//Reserva size bytes alineados a alignment (0 para la alineación de malloc) y los cuenta.
+//Retorno el puntero; lanza std::bad_alloc si no hay memoria
+inline void* CountedAllocate(std::size_t size, std::size_t alignment) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    heapBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    void* p = alignment == 0 ? std::malloc(size)
+                             : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) { return CountedAllocate(size, 0); }
+void* operator new[](std::size_t size) { return CountedAllocate(size, 0); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return CountedAllocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return CountedAllocate(size, static_cast<std::size_t>(alignment)); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+#endif
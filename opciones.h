@@ -0,0 +1,286 @@
+#ifndef OPCIONES_H
+#define OPCIONES_H
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstdint>
+#include <omp.h> // Librerías que importar
+
+const int DEFAULT_PARTICLES = 10;              //Partículas si no se ingresa un número válido.
+const int DEFAULT_HEADLESS_STEPS = 1000;       //Pasos por defecto del modo sin ventana.
+const int DEFAULT_SIMULATION_HZ = 60;          //Pasos de simulación por segundo simulado.
+const int DEFAULT_CHECKPOINT_STEPS = 600;      //Pasos entre instantáneas periódicas (10 s a 60 Hz).
+const int DEFAULT_RECORD_CHECKSUM_STEPS = 60;  //Pasos entre sumas del estado al grabar (1 s a 60 Hz).
+
+//Forma de dibujar las partículas.
+enum RenderMode {
+    RENDER_LEGACY,     // glBegin/glEnd con un GL_TRIANGLE_FAN por partícula
+    RENDER_INSTANCED,  // Vertex buffer y una sola llamada instanciada
+    RENDER_FANS        // Abanicos generados en paralelo y enviados con glMultiDrawArrays
+};
+
+//Cómo fijar los hilos de OpenMP a las CPUs.
+enum PinMode {
+    PIN_NONE,    // Sin afinidad: el sistema operativo decide
+    PIN_CLOSE,   // Hilos en CPUs consecutivas
+    PIN_SPREAD   // Hilos repartidos entre todas las CPUs
+};
+
+//Opciones de línea de comandos compartidas por secuencia.cpp, paralela.cpp y distribuida.cpp.
+struct Options {
+    int numParticles = DEFAULT_PARTICLES;
+    bool headless = false;                     // --headless: simula sin GLUT ni OpenGL
+    bool offscreen = false;                    // --offscreen: headless y además dibuja por software
+    const char* outputPath = nullptr;          // --output archivo: imágenes o video de --offscreen
+    int steps = DEFAULT_HEADLESS_STEPS;        // --steps K: pasos a simular en modo headless
+    int simulationHz = DEFAULT_SIMULATION_HZ;  // --hz N: frecuencia del paso fijo de simulación
+    RenderMode render = RENDER_INSTANCED;      // --render legacy|instanced|fans
+    bool collisions = false;                   // --collisions: choques elásticos entre partículas
+    bool verlet = false;                       // --verlet [margen]: listas de vecinos de Verlet
+    float verletSkin = 0.0f;                   // Margen de --verlet en píxeles, 0 para derivarlo del paso (DefaultVerletSkin)
+    bool neighbors = true;                     // --no-neighbors: sin promedio de colores vecinos
+    bool batchSubsteps = false;                // --batch-substeps: color, vecinos y choques una vez por tanda de subpasos
+    bool verify = false;                       // --verify: compara el paso con todos los hilos contra un hilo
+    bool kernels = false;                      // --kernels: mide cada combinación de fases del paso
+    bool checkAlloc = false;                   // --check-alloc: falla si un paso después del primero reserva memoria
+    omp_sched_t schedule = omp_sched_static;   // --schedule static|dynamic|guided[,chunk]
+    int scheduleChunk = 0;                     // 0: tamaño de bloque por defecto de OpenMP
+    int threads = 0;                           // --threads N: 0 usa el valor por defecto de OpenMP
+    PinMode pin = PIN_NONE;                    // --pin none|close|spread
+    bool csv = false;                          // --csv: resumen del modo headless en una línea CSV
+    const char* tracePath = nullptr;           // --trace archivo.json: exporta la traza de fases al salir
+    const char* loadPath = nullptr;            // --load archivo: empieza desde una instantánea
+    const char* checkpointPath = nullptr;      // --checkpoint archivo: guarda instantáneas periódicas
+    int checkpointEvery = DEFAULT_CHECKPOINT_STEPS; // --checkpoint-every K: pasos entre instantáneas
+    const char* recordPath = nullptr;          // --record archivo: graba la corrida para repetirla
+    const char* replayPath = nullptr;          // --replay archivo: repite una grabación sin ventana
+    int checksumEvery = DEFAULT_RECORD_CHECKSUM_STEPS; // --checksum-every K: subpasos entre sumas al grabar
+    int wall = 1;                              // --wall N: mundo de N ventanas de ancho (solo distribuida)
+    bool hasSeed = false;                      // --seed S: semilla para repetir una corrida
+    uint64_t seed = 0;
+};
+
+//IsPositiveNumber
+//1 Parametro
+//Revisa que el texto sea un entero no negativo que cabe en un int.
+//Retorno verdadero si es un número válido
+inline bool IsPositiveNumber(const char* text, int& value) {
+    if (*text == '\0') return false;
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (!std::isdigit(static_cast<unsigned char>(*c))) return false;
+    }
+    long long number = std::strtoll(text, nullptr, 10);
+    if (number > INT_MAX) return false;
+    value = static_cast<int>(number);
+    return true;
+}
+
+//ParseSchedule
+//2 Parametros
+//Lee un schedule de OpenMP con la forma tipo[,bloque], por ejemplo "dynamic,64".
+//Retorno verdadero si el texto es válido
+inline bool ParseSchedule(const char* text, Options& opts) {
+    std::string value = text;
+    std::string kind = value.substr(0, value.find(','));
+    int chunk = 0;
+    if (kind.size() < value.size() && !IsPositiveNumber(value.c_str() + kind.size() + 1, chunk)) return false;
+
+    if (kind == "static") opts.schedule = omp_sched_static;
+    else if (kind == "dynamic") opts.schedule = omp_sched_dynamic;
+    else if (kind == "guided") opts.schedule = omp_sched_guided;
+    else return false;
+    opts.scheduleChunk = chunk;
+    return true;
+}
+
+//ParseOptions
+//2 Parametros
+//Lee la cantidad de partículas (posicional) y las opciones --headless, --offscreen, --output, --steps, --hz, --render, --collisions,
+//--no-neighbors, --batch-substeps, --verlet, --verify, --kernels, --check-alloc, --schedule, --threads, --pin, --csv, --trace, --load, --checkpoint,
+//--checkpoint-every, --seed, --record, --replay, --checksum-every y --wall.
+//Programación defensiva: cualquier dato inválido se reporta y se usa el valor por defecto.
+//Retorno con las opciones leídas
+inline Options ParseOptions(int argc, char** argv) {
+    Options opts;
+    const char* countText = nullptr;
+
+    for (int a = 1; a < argc; a++) {
+        const char* arg = argv[a];
+        if (std::strcmp(arg, "--headless") == 0) {
+            opts.headless = true;
+        } else if (std::strcmp(arg, "--offscreen") == 0) {
+            opts.offscreen = true;
+            opts.headless = true;
+        } else if (std::strcmp(arg, "--output") == 0) {
+            if (a + 1 < argc) {
+                opts.outputPath = argv[++a];
+                opts.offscreen = true;
+                opts.headless = true;
+            } else {
+                std::cout << "--output necesita el nombre del archivo. Se ignora.\n";
+            }
+        } else if (std::strcmp(arg, "--verify") == 0) {
+            opts.verify = true;
+            opts.headless = true;
+        } else if (std::strcmp(arg, "--kernels") == 0) {
+            opts.kernels = true;
+            opts.headless = true;
+        } else if (std::strcmp(arg, "--check-alloc") == 0) {
+            opts.checkAlloc = true;
+            opts.headless = true;
+        } else if (std::strcmp(arg, "--steps") == 0) {
+            int steps = 0;
+            if (a + 1 < argc && IsPositiveNumber(argv[a + 1], steps) && steps > 0) {
+                opts.steps = steps;
+            } else {
+                std::cout << "--steps necesita un entero positivo. Usando " << DEFAULT_HEADLESS_STEPS << " por defecto.\n";
+            }
+            if (a + 1 < argc && argv[a + 1][0] != '-') a++;
+        } else if (std::strcmp(arg, "--hz") == 0) {
+            int hz = 0;
+            if (a + 1 < argc && IsPositiveNumber(argv[a + 1], hz) && hz > 0) {
+                opts.simulationHz = hz;
+            } else {
+                std::cout << "--hz necesita un entero positivo. Usando " << DEFAULT_SIMULATION_HZ << " por defecto.\n";
+            }
+            if (a + 1 < argc && argv[a + 1][0] != '-') a++;
+        } else if (std::strcmp(arg, "--render") == 0) {
+            const char* mode = a + 1 < argc ? argv[++a] : "";
+            if (std::strcmp(mode, "legacy") == 0) {
+                opts.render = RENDER_LEGACY;
+            } else if (std::strcmp(mode, "instanced") == 0) {
+                opts.render = RENDER_INSTANCED;
+            } else if (std::strcmp(mode, "fans") == 0) {
+                opts.render = RENDER_FANS;
+            } else {
+                std::cout << "--render debe ser legacy, instanced o fans. Usando instanced por defecto.\n";
+            }
+        } else if (std::strcmp(arg, "--schedule") == 0) {
+            if (a + 1 >= argc || !ParseSchedule(argv[++a], opts)) {
+                std::cout << "--schedule debe ser static, dynamic o guided, con un bloque opcional (dynamic,64). Usando static por defecto.\n";
+                opts.schedule = omp_sched_static;
+                opts.scheduleChunk = 0;
+            }
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            const char* text = a + 1 < argc ? argv[++a] : "";
+            bool digits = *text != '\0';
+            for (const char* c = text; *c != '\0'; ++c) digits = digits && std::isdigit(static_cast<unsigned char>(*c));
+            if (digits) {
+                opts.seed = std::strtoull(text, nullptr, 10);
+                opts.hasSeed = true;
+            } else {
+                std::cout << "--seed necesita un entero positivo. Se usa una semilla aleatoria.\n";
+            }
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            int threads = 0;
+            if (a + 1 < argc && IsPositiveNumber(argv[a + 1], threads) && threads > 0) {
+                opts.threads = threads;
+            } else {
+                std::cout << "--threads necesita un entero positivo. Usando el valor por defecto de OpenMP.\n";
+            }
+            if (a + 1 < argc && argv[a + 1][0] != '-') a++;
+        } else if (std::strcmp(arg, "--pin") == 0) {
+            const char* mode = a + 1 < argc ? argv[++a] : "";
+            if (std::strcmp(mode, "none") == 0) {
+                opts.pin = PIN_NONE;
+            } else if (std::strcmp(mode, "close") == 0) {
+                opts.pin = PIN_CLOSE;
+            } else if (std::strcmp(mode, "spread") == 0) {
+                opts.pin = PIN_SPREAD;
+            } else {
+                std::cout << "--pin debe ser none, close o spread. Sin afinidad por defecto.\n";
+            }
+        } else if (std::strcmp(arg, "--collisions") == 0) {
+            opts.collisions = true;
+        } else if (std::strcmp(arg, "--no-neighbors") == 0) {
+            opts.neighbors = false;
+        } else if (std::strcmp(arg, "--batch-substeps") == 0) {
+            opts.batchSubsteps = true;
+        } else if (std::strcmp(arg, "--verlet") == 0) {
+            opts.verlet = true;
+            if (a + 1 < argc && (std::isdigit(static_cast<unsigned char>(argv[a + 1][0])) || argv[a + 1][0] == '.')) {
+                char* end = nullptr;
+                const float skin = std::strtof(argv[++a], &end);
+                if (*end == '\0' && skin > 0.0f) {
+                    opts.verletSkin = skin;         // Margen opcional en píxeles
+                } else {
+                    std::cout << "--verlet necesita un margen positivo en píxeles. Se deriva del paso.\n";
+                }
+            }
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            opts.csv = true;
+        } else if (std::strcmp(arg, "--trace") == 0) {
+            if (a + 1 < argc) {
+                opts.tracePath = argv[++a];
+            } else {
+                std::cout << "--trace necesita el nombre del archivo. No se exporta la traza.\n";
+            }
+        } else if (std::strcmp(arg, "--load") == 0 || std::strcmp(arg, "--checkpoint") == 0) {
+            const char*& target = arg[2] == 'l' ? opts.loadPath : opts.checkpointPath;
+            if (a + 1 < argc) {
+                target = argv[++a];
+            } else {
+                std::cout << arg << " necesita el nombre del archivo. Se ignora.\n";
+            }
+        } else if (std::strcmp(arg, "--record") == 0 || std::strcmp(arg, "--replay") == 0) {
+            const char*& target = arg[4] == 'c' ? opts.recordPath : opts.replayPath;
+            if (a + 1 < argc) {
+                target = argv[++a];
+            } else {
+                std::cout << arg << " necesita el nombre del archivo. Se ignora.\n";
+            }
+            if (target == opts.replayPath && target != nullptr) opts.headless = true;
+        } else if (std::strcmp(arg, "--checksum-every") == 0) {
+            int every = 0;
+            if (a + 1 < argc && IsPositiveNumber(argv[a + 1], every) && every > 0) {
+                opts.checksumEvery = every;
+            } else {
+                std::cout << "--checksum-every necesita un entero positivo. Usando " << DEFAULT_RECORD_CHECKSUM_STEPS << " por defecto.\n";
+            }
+            if (a + 1 < argc && argv[a + 1][0] != '-') a++;
+        } else if (std::strcmp(arg, "--checkpoint-every") == 0) {
+            int every = 0;
+            if (a + 1 < argc && IsPositiveNumber(argv[a + 1], every) && every > 0) {
+                opts.checkpointEvery = every;
+            } else {
+                std::cout << "--checkpoint-every necesita un entero positivo. Usando " << DEFAULT_CHECKPOINT_STEPS << " por defecto.\n";
+            }
+            if (a + 1 < argc && argv[a + 1][0] != '-') a++;
+        } else if (std::strcmp(arg, "--wall") == 0) {
+            int screens = 0;
+            if (a + 1 < argc && IsPositiveNumber(argv[a + 1], screens) && screens > 0) {
+                opts.wall = screens;
+            } else {
+                std::cout << "--wall necesita un entero positivo. Usando una ventana de ancho.\n";
+            }
+            if (a + 1 < argc && argv[a + 1][0] != '-') a++;
+        } else if (arg[0] == '-' && arg[1] == '-') {
+            std::cout << "Opción desconocida " << arg << ". Se ignora.\n";
+        } else if (countText == nullptr) {
+            countText = arg;
+        } else {
+            std::cout << "Argumento extra " << arg << ". Se ignora.\n";
+        }
+    }
+
+    if (countText == nullptr) {
+        if (opts.loadPath != nullptr || opts.replayPath != nullptr) return opts; //El archivo define la cantidad
+        std::cout << "Uso por defecto de " << DEFAULT_PARTICLES << " partículas al no ingresar datos.\n";  //Se asegura que el usuario ingrese un input.
+        return opts;
+    }
+
+    int number = 0;
+    if (!IsPositiveNumber(countText, number)) {
+        // Seguridad. Asegura que sea un entero positivo
+        std::cout << "Debe de ingresar un número entero positivo, no String. Usando " << DEFAULT_PARTICLES << " por defecto.\n";
+    } else {
+        opts.numParticles = number;          // Obtiene el número de partículas a crear
+    }
+    return opts;
+}
+
+#endif
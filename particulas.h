@@ -0,0 +1,309 @@
+#ifndef PARTICULAS_H
+#define PARTICULAS_H
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <new>
+#include <atomic>
+#include <sys/mman.h> // Librerías que importar
+
+const int WINDOW_WIDTH = 1920;
+const int WINDOW_HEIGHT = 1080; //Tamaño de la pantalla.
+const float PARTICLE_RADIUS = 60.0f; //Tamaño de las partículas.
+const float MAX_SPEED = 600.0f; //Velocidad máxima en píxeles por segundo (10 píxeles por paso a 60 Hz).
+
+const size_t PARTICLE_ALIGNMENT = 64; //Alineación de cada arreglo (una línea de caché, un registro AVX-512).
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024; //Página grande de x86-64 (transparent huge pages).
+const int INTEGRATION_BLOCK = 512; //Partículas por bloque de subpasos (5 arreglos de 2 KB, caben en L1).
+
+//AllocateArena
+//2 Parametros
+//Reserva al menos bytes de memoria anónima con mmap, alineada a HUGE_PAGE_SIZE y marcada
+//con MADV_HUGEPAGE, para que millones de partículas usen pocas entradas del TLB. La memoria
+//llega en cero y cada página se asigna cuando se escribe por primera vez, así queda en el
+//nodo NUMA del hilo que la inicializa. Deja en mappedBytes el tamaño para ReleaseArena.
+//Retorno la memoria reservada; lanza std::bad_alloc si no hay
+inline void* AllocateArena(size_t bytes, size_t& mappedBytes) {
+    const size_t size = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    //Se pide una página grande de más para recortar el inicio hasta la alineación.
+    void* raw = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (aligned > start) munmap(raw, aligned - start);
+    const size_t tail = start + size + HUGE_PAGE_SIZE - (aligned + size);
+    if (tail > 0) munmap(reinterpret_cast<void*>(aligned + size), tail);
+
+#ifdef MADV_HUGEPAGE
+    madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE); //Si el kernel no lo soporta, se queda con páginas normales
+#endif
+    mappedBytes = size;
+    return reinterpret_cast<void*>(aligned);
+}
+
+//ReleaseArena
+//2 Parametros
+//Libera la memoria de AllocateArena.
+//Retorno nulo
+inline void ReleaseArena(void* block, size_t mappedBytes) {
+    if (block != nullptr) munmap(block, mappedBytes);
+}
+
+//Sistema de partículas guardado como estructura de arreglos (SoA). Cada campo de la
+//antigua struct Particle es un arreglo alineado, de modo que los ciclos que recorren
+//un campo a la vez acceden a memoria contigua y el compilador los puede vectorizar.
+//Todos los arreglos viven en un solo bloque de memoria (AllocateArena).
+struct ParticleSystem {
+    float* velocityX = nullptr;
+    float* velocityY = nullptr;
+    float* posX = nullptr;
+    float* posY = nullptr;
+    float* colorR = nullptr;
+    float* colorG = nullptr;
+    float* colorB = nullptr;
+    float* color_change = nullptr;
+    float* radius = nullptr;
+    float* previousX = nullptr;  // Posición al inicio de la tanda que produjo este estado,
+    float* previousY = nullptr;  // para interpolar el dibujo
+
+    int count = 0;       // Cantidad de partículas
+    size_t stride = 0;   // Elementos reservados por arreglo (múltiplo de la alineación)
+    void* block = nullptr;
+    size_t blockBytes = 0;    // Tamaño mapeado del bloque
+    double time = 0.0;        // Segundos simulados hasta este estado
+    double batchTime = 0.0;   // Segundos simulados por la tanda que lo produjo (0 al crear)
+
+    //Tabla de columnas para las operaciones que tratan todos los campos por igual.
+    static constexpr float* ParticleSystem::* COLUMNS[] = {
+        &ParticleSystem::velocityX, &ParticleSystem::velocityY,
+        &ParticleSystem::posX, &ParticleSystem::posY,
+        &ParticleSystem::colorR, &ParticleSystem::colorG, &ParticleSystem::colorB,
+        &ParticleSystem::color_change, &ParticleSystem::radius,
+        &ParticleSystem::previousX, &ParticleSystem::previousY
+    };
+    static constexpr int NUM_COLUMNS = sizeof(COLUMNS) / sizeof(COLUMNS[0]);
+
+    ParticleSystem() = default;
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+    ~ParticleSystem() { Release(); }
+
+    //Allocate
+    //1 Parametro
+    //Reserva los arreglos para n partículas, inicializados en cero. Las páginas se asignan
+    //cuando se escriben por primera vez (en CreateParticle, con todos los hilos).
+    //Retorno nulo
+    void Allocate(int n) {
+        Release();
+        const size_t perLine = PARTICLE_ALIGNMENT / sizeof(float);
+        count = n;
+        stride = (static_cast<size_t>(n) + perLine - 1) / perLine * perLine;
+        if (stride == 0) stride = perLine;
+
+        const size_t bytes = stride * NUM_COLUMNS * sizeof(float);
+        block = AllocateArena(bytes, blockBytes);
+
+        float* base = static_cast<float*>(block);
+        for (int k = 0; k < NUM_COLUMNS; k++) {
+            this->*COLUMNS[k] = base + k * stride;
+        }
+    }
+
+    //Adopt
+    //3 Parametros
+    //Usa como bloque un mapeo ya hecho de bytes bytes (una instantánea de instantanea.h),
+    //con las columnas a partir de offset, en lugar de la memoria propia. count y stride no
+    //cambian; Release() libera el mapeo igual que un bloque propio.
+    //Retorno nulo
+    void Adopt(void* mapping, size_t bytes, size_t offset) {
+        ReleaseArena(block, blockBytes);
+        block = mapping;
+        blockBytes = bytes;
+        float* base = reinterpret_cast<float*>(static_cast<char*>(mapping) + offset);
+        for (int k = 0; k < NUM_COLUMNS; k++) {
+            this->*COLUMNS[k] = base + k * stride;
+        }
+    }
+
+    //Release
+    //0 Parametros
+    //Libera la memoria de las partículas.
+    //Retorno nulo
+    void Release() {
+        ReleaseArena(block, blockBytes);
+        block = nullptr;
+        blockBytes = 0;
+        for (int k = 0; k < NUM_COLUMNS; k++) {
+            this->*COLUMNS[k] = nullptr;
+        }
+        count = 0;
+        stride = 0;
+        time = 0.0;
+        batchTime = 0.0;
+    }
+};
+
+//Tres copias del estado de las partículas que rotan sin locks (triple buffer).
+//El simulador lee Front() (el último estado terminado) y escribe Back(); Swap() publica el
+//estado nuevo dejándolo en la copia del medio con un intercambio atómico. El que dibuja
+//toma con Latest() la copia del medio si hay una nueva y la lee mientras el simulador
+//sigue con las otras dos, así que simular y dibujar pueden correr a la vez en hilos
+//distintos. Con un solo hilo se comporta como un doble buffer.
+struct ParticleBuffers {
+    static constexpr int FRESH = 4;  // Bit de "copia del medio sin leer"
+    static constexpr int INDEX = 3;
+
+    ParticleSystem buffers[3];
+    int front = 0;                   // Último estado terminado (solo el simulador)
+    int back = 1;                    // Estado en construcción (solo el simulador)
+    std::atomic<int> middle{0};      // Copia publicada, compartida entre los dos hilos
+    int display = 2;                 // Copia que se dibuja (solo el que dibuja)
+    long long step = 0;  // Pasos simulados (también es el contador del generador aleatorio)
+
+    ParticleSystem& Front() { return buffers[front]; }
+    ParticleSystem& Back() { return buffers[back]; }
+    const ParticleSystem& Front() const { return buffers[front]; }
+
+    void Allocate(int n) {
+        for (ParticleSystem& buffer : buffers) buffer.Allocate(n);
+        front = 0;
+        back = 1;
+        middle.store(0 | FRESH, std::memory_order_relaxed);
+        display = 2;
+        step = 0;
+    }
+
+    //Swap
+    //0 Parametros
+    //El estado recién escrito pasa a ser el frente y se publica en la copia del medio. La
+    //copia que estaba en el medio (ya leída o descartada) es el nuevo destino.
+    //Retorno nulo
+    void Swap() {
+        front = back;
+        back = middle.exchange(front | FRESH, std::memory_order_acq_rel) & INDEX;
+        step++;
+    }
+
+    //Latest
+    //0 Parametros
+    //Lado del que dibuja: cambia su copia por la del medio si el simulador publicó una nueva.
+    //Retorno el estado más reciente publicado
+    const ParticleSystem& Latest() {
+        if (middle.load(std::memory_order_relaxed) & FRESH) {
+            display = middle.exchange(display, std::memory_order_acq_rel) & INDEX;
+        }
+        return buffers[display];
+    }
+};
+
+//CopyParticles
+//2 Parametros
+//Copia todos los campos de src a dst (mismo tamaño). Es un "omp for" huérfano sobre
+//bloques de cada columna: dentro de una región paralela copian todos los hilos.
+//Retorno nulo
+inline void CopyParticles(const ParticleSystem& src, ParticleSystem& dst) {
+    const size_t chunk = 1 << 16; //Floats por bloque (256 KB)
+    const long long chunksPerColumn = (static_cast<long long>(src.count) + chunk - 1) / chunk;
+    #pragma omp single nowait
+    {
+        dst.time = src.time;
+        dst.batchTime = src.batchTime;
+    }
+    #pragma omp for schedule(static)
+    for (long long b = 0; b < ParticleSystem::NUM_COLUMNS * chunksPerColumn; b++) {
+        const int k = static_cast<int>(b / chunksPerColumn);
+        const size_t begin = static_cast<size_t>(b % chunksPerColumn) * chunk;
+        const size_t count = std::min(chunk, static_cast<size_t>(src.count) - begin);
+        std::memcpy(dst.*ParticleSystem::COLUMNS[k] + begin, src.*ParticleSystem::COLUMNS[k] + begin, count * sizeof(float));
+    }
+}
+
+//FindMismatch
+//4 Parametros
+//Compara bit a bit dos sistemas de partículas.
+//Retorno verdadero si son idénticos; si no, deja en column/index el primer campo distinto
+inline bool FindMismatch(const ParticleSystem& a, const ParticleSystem& b, int& column, int& index) {
+    for (int k = 0; k < ParticleSystem::NUM_COLUMNS; k++) {
+        const float* x = a.*ParticleSystem::COLUMNS[k];
+        const float* y = b.*ParticleSystem::COLUMNS[k];
+        if (std::memcmp(x, y, a.count * sizeof(float)) == 0) continue;
+        for (int i = 0; i < a.count; i++) {
+            if (std::memcmp(&x[i], &y[i], sizeof(float)) != 0) {
+                column = k;
+                index = i;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const char* const COLUMN_NAMES[ParticleSystem::NUM_COLUMNS] = {
+    "velocityX", "velocityY", "posX", "posY", "colorR", "colorG", "colorB", "color_change", "radius",
+    "previousX", "previousY"
+};
+
+//IntegrateParticles
+//5 Parametros
+//Calcula en dst las posiciones de src avanzadas substeps pasos de dt segundos según su
+//velocidad, rebotando contra las paredes de la ventana en cada uno (también copia el radio y
+//guarda la posición inicial en previousX/previousY). worldWidth permite un mundo más ancho
+//que la ventana, como la pared de pantallas de distribuida.cpp.
+//Solo lee src y solo escribe dst. Los subpasos se hacen por bloques de INTEGRATION_BLOCK
+//partículas: el primero lee src y los demás actualizan dst en el lugar mientras el bloque
+//sigue en la caché L1, así varios pasos de física cuestan una sola pasada por memoria.
+//Usa un "omp for" huérfano sobre los bloques: dentro de una región paralela reparte el
+//trabajo entre los hilos, y fuera de ella corre en un solo hilo. El cuerpo no tiene saltos,
+//así el compilador lo vectoriza (AVX2/AVX-512 con -march=native, escalar en otro caso).
+//Retorno nulo
+inline void IntegrateParticles(const ParticleSystem& src, ParticleSystem& dst, float dt, int substeps, float worldWidth = WINDOW_WIDTH) {
+    const int n = src.count;
+    const float halfWidth = worldWidth / 2;
+    const float halfHeight = WINDOW_HEIGHT / 2;
+    const float* radius = src.radius;
+    float* posX = dst.posX;
+    float* posY = dst.posY;
+    float* velocityX = dst.velocityX;
+    float* velocityY = dst.velocityY;
+
+    #pragma omp for schedule(static)
+    for (int start = 0; start < n; start += INTEGRATION_BLOCK) {
+        const int end = start + INTEGRATION_BLOCK < n ? start + INTEGRATION_BLOCK : n;
+        const float* inX = src.posX;
+        const float* inY = src.posY;
+        const float* inVelocityX = src.velocityX;
+        const float* inVelocityY = src.velocityY;
+
+        for (int s = 0; s < substeps; s++) {
+            #pragma omp simd
+            for (int i = start; i < end; i++) {
+                const float x = inX[i] + inVelocityX[i] * dt;
+                const float y = inY[i] + inVelocityY[i] * dt;
+
+                //La nueva velocidad en el caso que si se topa en la pantalla.
+                const bool bounceX = (x < -halfWidth + radius[i]) | (x > halfWidth - radius[i]);
+                const bool bounceY = (y < -halfHeight + radius[i]) | (y > halfHeight - radius[i]);
+                velocityX[i] = bounceX ? -inVelocityX[i] : inVelocityX[i];
+                velocityY[i] = bounceY ? -inVelocityY[i] : inVelocityY[i];
+                posX[i] = x;
+                posY[i] = y;
+            }
+            inX = posX;
+            inY = posY;
+            inVelocityX = velocityX;
+            inVelocityY = velocityY;
+        }
+
+        #pragma omp simd
+        for (int i = start; i < end; i++) {
+            dst.radius[i] = radius[i];
+            dst.previousX[i] = src.posX[i];
+            dst.previousY[i] = src.posY[i];
+        }
+    }
+}
+
+#endif
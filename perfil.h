@@ -0,0 +1,180 @@
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <cstdio>
+#include <iostream>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <omp.h> // Librerías que importar
+
+//Fases de un frame que se miden por separado. Las primeras NUM_SIM_PHASES son del paso de
+//simulación (las reporta el modo headless); las demás son del dibujo.
+enum Phase {
+    PHASE_INTEGRATION,
+    PHASE_COLOR,
+    PHASE_GRID,
+    PHASE_NEIGHBORS,
+    PHASE_COLLISIONS,
+    PHASE_UPLOAD,
+    PHASE_DRAW,
+    PHASE_SWAP,
+    NUM_PHASES
+};
+
+const int NUM_SIM_PHASES = PHASE_UPLOAD;
+
+const char* const PHASE_NAMES[NUM_PHASES] = { "Integración", "Cambio de color", "Grilla", "Vecinos", "Colisiones", "Subida", "Dibujo", "Swap" };
+const char* const PHASE_LABELS[NUM_PHASES] = { "integracion", "color", "grilla", "vecinos", "colisiones", "subida", "dibujo", "swap" }; //ASCII, para el overlay
+
+//Perfilado de fases con timers por alcance (PERFIL_FASE). Cada hilo escribe sus eventos en
+//su propio anillo sin locks; al salir se exportan como JSON de Chrome trace
+//(chrome://tracing o Perfetto). Compilar con -DSIN_PERFIL lo elimina por completo.
+#ifndef SIN_PERFIL
+
+const int TRACE_RING_SIZE = 1 << 16; //Eventos por hilo (se guardan los últimos).
+const int TRACE_MAX_THREADS = 256;
+
+struct TraceEvent {
+    uint64_t start;      // ns desde el inicio del programa
+    uint32_t duration;   // ns
+    uint32_t phase;
+};
+
+//Anillo de un hilo. Solo ese hilo escribe; head se publica con release para que el lector
+//(overlay o exportación) vea eventos completos.
+struct alignas(64) TraceRing {
+    TraceEvent events[TRACE_RING_SIZE];
+    std::atomic<uint64_t> head{0};
+    int thread = 0;
+};
+
+struct Profiler {
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    TraceRing* rings[TRACE_MAX_THREADS] = {};
+    std::atomic<int> numRings{0};
+    std::atomic<uint32_t> lastDuration[NUM_PHASES] = {}; // Última duración de cada fase, para el overlay
+    std::atomic<std::thread::id> simulationThread{std::this_thread::get_id()}; // Hilo que simula (por defecto el principal)
+    const char* tracePath = nullptr;
+
+    uint64_t Now() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    //Ring
+    //0 Parametros
+    //Anillo del hilo actual; la primera vez lo crea y lo registra con un contador atómico.
+    //Retorno el anillo, nullptr si ya no hay espacio
+    TraceRing* Ring() {
+        thread_local TraceRing* ring = nullptr;
+        if (ring == nullptr) {
+            int slot = numRings.fetch_add(1);
+            if (slot >= TRACE_MAX_THREADS) return nullptr;
+            ring = new TraceRing();
+            ring->thread = slot;
+            rings[slot] = ring;
+        }
+        return ring;
+    }
+
+    //SetSimulationThread
+    //0 Parametros
+    //Marca el hilo actual como el que simula; lo llama SimulationLoop en paralela.cpp, donde
+    //el paso corre en un hilo aparte del de GLUT.
+    //Retorno nulo
+    void SetSimulationThread() {
+        simulationThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    }
+
+    //Record
+    //3 Parametros
+    //Guarda un evento en el anillo del hilo actual. Para el overlay guarda la duración de las
+    //fases de simulación solo del hilo que simula, y la de las de dibujo solo del hilo 0 del
+    //equipo que dibuja; así no se mezclan los dos hilos 0 de paralela.cpp (GLUT y simulación).
+    //Retorno nulo
+    void Record(Phase phase, uint64_t start, uint64_t end) {
+        TraceRing* ring = Ring();
+        if (ring == nullptr) return;
+        const uint32_t duration = static_cast<uint32_t>(end - start);
+        const uint64_t head = ring->head.load(std::memory_order_relaxed);
+        ring->events[head % TRACE_RING_SIZE] = TraceEvent{ start, duration, static_cast<uint32_t>(phase) };
+        ring->head.store(head + 1, std::memory_order_release);
+        const bool overlay = phase < NUM_SIM_PHASES ? std::this_thread::get_id() == simulationThread.load(std::memory_order_relaxed)
+                                                    : omp_get_thread_num() == 0;
+        if (overlay) lastDuration[phase].store(duration, std::memory_order_relaxed);
+    }
+
+    //LastMilliseconds
+    //1 Parametro
+    //Última duración medida de una fase (ver Record: hilo que simula o hilo que dibuja).
+    //Retorno la duración en milisegundos
+    float LastMilliseconds(Phase phase) const {
+        return lastDuration[phase].load(std::memory_order_relaxed) * 1e-6f;
+    }
+
+    //WriteChromeTrace
+    //1 Parametro
+    //Escribe los eventos guardados en formato JSON de Chrome trace.
+    //Retorno verdadero si se pudo escribir el archivo
+    bool WriteChromeTrace(const char* path) const {
+        std::FILE* file = std::fopen(path, "w");
+        if (file == nullptr) return false;
+        std::fprintf(file, "{\"traceEvents\":[\n");
+        bool first = true;
+        const int count = numRings.load() < TRACE_MAX_THREADS ? numRings.load() : TRACE_MAX_THREADS;
+        for (int r = 0; r < count; r++) {
+            const TraceRing* ring = rings[r];
+            if (ring == nullptr) continue;
+            const uint64_t head = ring->head.load(std::memory_order_acquire);
+            const uint64_t begin = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+            for (uint64_t k = begin; k < head; k++) {
+                const TraceEvent& e = ring->events[k % TRACE_RING_SIZE];
+                std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                             first ? "" : ",\n", PHASE_LABELS[e.phase], ring->thread, e.start * 1e-3, e.duration * 1e-3);
+                first = false;
+            }
+        }
+        std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+        return std::fclose(file) == 0;
+    }
+};
+
+Profiler profiler; //Perfilador global del programa.
+
+//Timer por alcance: mide desde su creación hasta el final del bloque.
+struct ScopedPhase {
+    Phase phase;
+    uint64_t start;
+    explicit ScopedPhase(Phase p) : phase(p), start(profiler.Now()) {}
+    ~ScopedPhase() { profiler.Record(phase, start, profiler.Now()); }
+};
+
+#define PERFIL_CONCAT_(a, b) a##b
+#define PERFIL_CONCAT(a, b) PERFIL_CONCAT_(a, b)
+#define PERFIL_FASE(phase) ScopedPhase PERFIL_CONCAT(perfilScope, __LINE__)(phase)
+
+//WriteTraceAtExit
+//0 Parametros
+//Función para atexit: exporta la traza si se pidió con --trace. El aviso va por std::cout,
+//que con --output - apunta a stderr y no mezcla texto con el video.
+//Retorno nulo
+inline void WriteTraceAtExit() {
+    if (profiler.tracePath == nullptr) return;
+    if (profiler.WriteChromeTrace(profiler.tracePath)) {
+        std::cout << "Traza escrita en " << profiler.tracePath << "\n";
+    } else {
+        std::cout << "No se pudo escribir la traza en " << profiler.tracePath << "\n";
+    }
+}
+
+#define PERFIL_ACTIVO 1
+
+#else
+
+#define PERFIL_FASE(phase) ((void)0)
+#define PERFIL_ACTIVO 0
+
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef POLITICAS_H
+#define POLITICAS_H
+
+#include <iostream>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <omp.h>
+#include "particulas.h"
+#include "verlet.h" // Librerías que importar
+
+//Búsqueda de vecinos del paso de simulación.
+enum NeighborMode {
+    NEIGHBORS_GRID,      // Grilla reconstruida en cada paso (por defecto)
+    NEIGHBORS_VERLET,    // Listas de Verlet (--verlet)
+    NEIGHBORS_OFF,       // Sin promedio de colores vecinos (--no-neighbors)
+    NUM_NEIGHBOR_MODES
+};
+
+//Combinación de fases del paso, fija en compilación. StepParticlesWith<Policy> de
+//secuencia.cpp y paralela.cpp se instancia una vez por combinación: cada una es una función
+//distinta que solo tiene el código de sus fases, sin revisar opciones dentro del paso.
+template <NeighborMode Neighbors, bool Collisions>
+struct StepPolicy {
+    static constexpr NeighborMode neighbors = Neighbors;
+    static constexpr bool collisions = Collisions;
+};
+
+const int NUM_STEP_KERNELS = NUM_NEIGHBOR_MODES * 2;
+
+//KernelIndex
+//2 Parametros
+//Posición de la combinación en la tabla de MakeStepKernels (vecinos por fila, sin y con
+//choques por columna).
+//Retorno el índice
+inline int KernelIndex(NeighborMode neighbors, bool collisions) {
+    return static_cast<int>(neighbors) * 2 + (collisions ? 1 : 0);
+}
+
+//KernelName
+//1 Parametro
+//Nombre de la combinación para los reportes, por ejemplo "grilla + choques".
+//Retorno el nombre
+inline const char* KernelName(int index) {
+    static const char* const names[NUM_STEP_KERNELS] = {
+        "grilla", "grilla + choques", "verlet", "verlet + choques", "sin vecinos", "sin vecinos + choques"
+    };
+    return names[index];
+}
+
+typedef void (*StepKernel)(ParticleBuffers&, float, int);
+typedef std::array<StepKernel, NUM_STEP_KERNELS> StepKernelTable;
+
+//MakeStepKernels
+//1 Parametro
+//Tabla con una instancia del paso por combinación, en el orden de KernelIndex. instance
+//recibe un StepPolicy y devuelve la instancia del programa para esa combinación
+//(StepParticlesWith<Policy>), así secuencia.cpp y paralela.cpp arman la misma tabla.
+//Retorno la tabla
+template <class Instance>
+inline StepKernelTable MakeStepKernels(Instance instance) {
+    return StepKernelTable{
+        instance(StepPolicy<NEIGHBORS_GRID, false>{}), instance(StepPolicy<NEIGHBORS_GRID, true>{}),
+        instance(StepPolicy<NEIGHBORS_VERLET, false>{}), instance(StepPolicy<NEIGHBORS_VERLET, true>{}),
+        instance(StepPolicy<NEIGHBORS_OFF, false>{}), instance(StepPolicy<NEIGHBORS_OFF, true>{})
+    };
+}
+
+//VerifyKernels
+//8 Parametros
+//Prueba de --verify: desde el mismo estado inicial (create) corre step sobre particles con
+//threads hilos y sobre una copia con un solo hilo (el orden secuencial), en tandas de 1 a
+//3 subpasos, y compara bit a bit el estado después de cada tanda. Con useVerlet cada corrida
+//construye sus propias listas: la de un hilo usa unas nuevas del mismo margen. secuencia.cpp
+//pasa threads = 1: las dos corridas son secuenciales y la prueba revisa que se repitan igual.
+//Retorno 0 si son idénticos, 1 si hay diferencias
+inline int VerifyKernels(ParticleBuffers& particles, VerletList& verlet, bool useVerlet, int steps, float deltaTime,
+                         void (*create)(), void (*step)(ParticleBuffers&, float, int), int threads) {
+
+    create();
+    const int n = particles.Front().count;
+    ParticleBuffers reference;
+    reference.Allocate(n);
+    CopyParticles(particles.Front(), reference.Front());
+    reference.step = particles.step;
+    VerletList referenceVerlet;
+    if (useVerlet) referenceVerlet.Init(n, verlet.skin);
+
+    for (int s = 0; s < steps; s++) {
+        const int substeps = s % 3 + 1; //Tandas de 1 a 3 subpasos (en una pasada con --batch-substeps)
+        omp_set_num_threads(1);
+        std::swap(verlet, referenceVerlet);
+        step(reference, deltaTime, substeps);
+        std::swap(verlet, referenceVerlet);
+        omp_set_num_threads(threads);
+        step(particles, deltaTime, substeps);
+
+        int column = 0, index = 0;
+        if (!FindMismatch(reference.Front(), particles.Front(), column, index)) {
+            std::cout << "Diferencia en el paso " << s + 1 << ", partícula " << index << ", campo " << COLUMN_NAMES[column]
+                      << ": un hilo " << (reference.Front().*ParticleSystem::COLUMNS[column])[index]
+                      << ", " << threads << " hilos " << (particles.Front().*ParticleSystem::COLUMNS[column])[index] << "\n";
+            return 1;
+        }
+    }
+    if (threads > 1) {
+        std::cout << "Verificación correcta: " << steps << " pasos con " << threads << " hilos idénticos a 1 hilo.\n";
+    } else {
+        std::cout << "Verificación correcta: " << steps << " pasos idénticos al repetirlos.\n";
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,418 @@
+#ifndef RASTERIZADOR_H
+#define RASTERIZADOR_H
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <omp.h>
+#include "particulas.h" // Librerías que importar
+
+//Dibujo por software, sin OpenGL ni servidor gráfico (--offscreen). La imagen se divide en
+//tiles de RASTER_TILE x RASTER_TILE píxeles; cada partícula se agrega a la lista de los
+//tiles que toca (binning) y después cada hilo pinta tiles completos, así ningún píxel lo
+//escriben dos hilos y cada tile cabe en la caché L2 mientras se pinta.
+const int RASTER_TILE = 64;
+const uint32_t RASTER_BACKGROUND = 0xFF000000u; //Negro opaco (RGBA en memoria: R, G, B, A).
+const float RASTER_MIN_RADIUS = 1.0f; //Radio mínimo en píxeles, como los puntos del dibujo legacy.
+
+struct SoftwareRenderer {
+    int width = WINDOW_WIDTH;
+    int height = WINDOW_HEIGHT;
+    int tilesX = 0;
+    int tilesY = 0;
+    float scale = 1.0f;                // Píxeles por unidad del mundo
+
+    std::vector<uint32_t> pixels;      // RGBA8, fila 0 arriba
+    std::vector<float> screenX;        // Centro, radio y color de cada partícula en pantalla
+    std::vector<float> screenY;
+    std::vector<float> screenR;
+    std::vector<uint32_t> color;
+    std::vector<int> tileStart;        // Inicio de cada tile en tileParticles (numTiles + 1)
+    std::vector<int> tileParticles;    // Partículas de cada tile, en orden ascendente
+    std::vector<int> threadOffset;     // Conteo / desplazamientos por hilo y tile
+
+    //Init
+    //3 Parametros
+    //Reserva la imagen de w x h píxeles (el mundo de la ventana se escala a ese tamaño) y los
+    //arreglos de Bin para n partículas con su tamaño máximo, así dibujar no reserva memoria.
+    //Retorno nulo
+    void Init(int w, int h, int n) {
+        width = w;
+        height = h;
+        scale = static_cast<float>(w) / WINDOW_WIDTH;
+        tilesX = (w + RASTER_TILE - 1) / RASTER_TILE;
+        tilesY = (h + RASTER_TILE - 1) / RASTER_TILE;
+        pixels.assign(static_cast<size_t>(w) * h, RASTER_BACKGROUND);
+        tileStart.assign(tilesX * tilesY + 1, 0);
+        threadOffset.resize(static_cast<size_t>(omp_get_max_threads()) * NumTiles());
+        screenX.resize(n);
+        screenY.resize(n);
+        screenR.resize(n);
+        color.resize(n);
+        tileParticles.resize(static_cast<size_t>(n) * MaxTilesPerParticle());
+    }
+
+    int NumTiles() const { return tilesX * tilesY; }
+
+    //MaxTilesPerParticle
+    //0 Parametros
+    //Cota de los tiles que toca un círculo de radio PARTICLE_RADIUS: su diámetro en píxeles
+    //cruza a lo más 2R / RASTER_TILE + 2 tiles por eje (3 x 3 con R = 60 < RASTER_TILE).
+    //Retorno la cantidad máxima de tiles
+    int MaxTilesPerParticle() const {
+        const float radius = std::max(PARTICLE_RADIUS * scale, RASTER_MIN_RADIUS);
+        const int perAxis = static_cast<int>(2.0f * radius / RASTER_TILE) + 2;
+        return std::min(perAxis, tilesX) * std::min(perAxis, tilesY);
+    }
+
+    //PixelRange
+    //4 Parametros
+    //Píxeles [first, last] cuyo centro puede caer en el círculo de centro c y radio r en un
+    //eje de size píxeles.
+    //Retorno falso si el círculo queda fuera de la imagen en ese eje
+    static bool PixelRange(float c, float r, int size, int& first, int& last) {
+        first = std::max(0, static_cast<int>(std::ceil(c - r - 0.5f)));
+        last = std::min(size - 1, static_cast<int>(std::floor(c + r - 0.5f)));
+        return first <= last;
+    }
+
+    //Bin
+    //2 Parametros
+    //Pasa las partículas a coordenadas de pantalla (con la posición interpolada con t) y las
+    //reparte en las listas de los tiles que tocan, con un counting sort como el de
+    //SpatialGrid::Build: cada hilo cuenta y reparte un bloque contiguo, así cada lista queda
+    //en el orden de las partículas (el mismo orden de dibujo que OpenGL) con cualquier
+    //cantidad de hilos. Debe llamarse desde todos los hilos del equipo (o fuera de una región
+    //paralela). Init ya los dimensiona; solo crecen si cambia n.
+    //Retorno nulo
+    void Bin(const ParticleSystem& particles, float t) {
+        const int n = particles.count;
+        const int numTiles = NumTiles();
+        const int tid = omp_get_thread_num();
+        const int numThreads = omp_get_num_threads();
+
+        #pragma omp single
+        {
+            threadOffset.assign(static_cast<size_t>(numThreads) * numTiles, 0);
+            if (screenX.size() < static_cast<size_t>(n)) {
+                screenX.resize(n);
+                screenY.resize(n);
+                screenR.resize(n);
+                color.resize(n);
+            }
+        }
+
+        const int begin = static_cast<int>(static_cast<long long>(n) * tid / numThreads);
+        const int end = static_cast<int>(static_cast<long long>(n) * (tid + 1) / numThreads);
+        int* offset = &threadOffset[static_cast<size_t>(tid) * numTiles];
+
+        //Coordenadas de pantalla y conteo por tile del bloque de este hilo.
+        for (int i = begin; i < end; i++) {
+            const float x = particles.previousX[i] + (particles.posX[i] - particles.previousX[i]) * t;
+            const float y = particles.previousY[i] + (particles.posY[i] - particles.previousY[i]) * t;
+            screenX[i] = (x + WINDOW_WIDTH / 2) * scale;
+            screenY[i] = (WINDOW_HEIGHT / 2 - y) * scale;   // El eje y de la imagen crece hacia abajo
+            screenR[i] = std::max(particles.radius[i] * scale, RASTER_MIN_RADIUS);
+            color[i] = static_cast<uint32_t>(particles.colorR[i] * 255.0f + 0.5f)
+                       | static_cast<uint32_t>(particles.colorG[i] * 255.0f + 0.5f) << 8
+                       | static_cast<uint32_t>(particles.colorB[i] * 255.0f + 0.5f) << 16
+                       | 0xFF000000u;
+
+            int x0, x1, y0, y1;
+            if (!PixelRange(screenX[i], screenR[i], width, x0, x1) || !PixelRange(screenY[i], screenR[i], height, y0, y1)) continue;
+            for (int ty = y0 / RASTER_TILE; ty <= y1 / RASTER_TILE; ty++) {
+                for (int tx = x0 / RASTER_TILE; tx <= x1 / RASTER_TILE; tx++) {
+                    offset[ty * tilesX + tx]++;
+                }
+            }
+        }
+        #pragma omp barrier
+
+        //Suma prefija por (tile, hilo) para obtener dónde escribe cada hilo.
+        #pragma omp single
+        {
+            int sum = 0;
+            for (int tile = 0; tile < numTiles; tile++) {
+                tileStart[tile] = sum;
+                for (int k = 0; k < numThreads; k++) {
+                    const int count = threadOffset[static_cast<size_t>(k) * numTiles + tile];
+                    threadOffset[static_cast<size_t>(k) * numTiles + tile] = sum;
+                    sum += count;
+                }
+            }
+            tileStart[numTiles] = sum;
+            if (tileParticles.size() < static_cast<size_t>(sum)) tileParticles.resize(sum); //Solo si algún radio supera PARTICLE_RADIUS (Init)
+        }
+
+        //Reparto de las partículas a sus tiles.
+        for (int i = begin; i < end; i++) {
+            int x0, x1, y0, y1;
+            if (!PixelRange(screenX[i], screenR[i], width, x0, x1) || !PixelRange(screenY[i], screenR[i], height, y0, y1)) continue;
+            for (int ty = y0 / RASTER_TILE; ty <= y1 / RASTER_TILE; ty++) {
+                for (int tx = x0 / RASTER_TILE; tx <= x1 / RASTER_TILE; tx++) {
+                    tileParticles[offset[ty * tilesX + tx]++] = i;
+                }
+            }
+        }
+        #pragma omp barrier
+    }
+
+    //Raster
+    //0 Parametros
+    //Pinta la imagen tile por tile: fondo negro y después los círculos del tile en orden.
+    //Cada fila de un círculo se pinta con un ciclo vectorizado que prueba si el centro de
+    //cada píxel cae en el disco y elige entre el color y el valor anterior (blend con
+    //máscara). "omp for" huérfano con reparto dinámico, porque los tiles tienen cantidades
+    //de partículas muy distintas.
+    //Retorno nulo
+    void Raster() {
+        const int numTiles = NumTiles();
+        #pragma omp for schedule(dynamic, 1)
+        for (int tile = 0; tile < numTiles; tile++) {
+            const int left = (tile % tilesX) * RASTER_TILE;
+            const int top = (tile / tilesX) * RASTER_TILE;
+            const int right = std::min(left + RASTER_TILE, width) - 1;
+            const int bottom = std::min(top + RASTER_TILE, height) - 1;
+
+            for (int py = top; py <= bottom; py++) {
+                std::fill(&pixels[static_cast<size_t>(py) * width + left], &pixels[static_cast<size_t>(py) * width + right] + 1, RASTER_BACKGROUND);
+            }
+
+            for (int k = tileStart[tile]; k < tileStart[tile + 1]; k++) {
+                const int i = tileParticles[k];
+                const float cx = screenX[i], cy = screenY[i], r = screenR[i];
+                const float r2 = r * r;
+                const uint32_t c = color[i];
+                int x0, x1, y0, y1;
+                PixelRange(cx, r, width, x0, x1);
+                PixelRange(cy, r, height, y0, y1);
+                x0 = std::max(x0, left);
+                x1 = std::min(x1, right);
+                y0 = std::max(y0, top);
+                y1 = std::min(y1, bottom);
+
+                for (int py = y0; py <= y1; py++) {
+                    const float dy = py + 0.5f - cy;
+                    const float dy2 = dy * dy;
+                    uint32_t* row = &pixels[static_cast<size_t>(py) * width];
+                    #pragma omp simd
+                    for (int px = x0; px <= x1; px++) {
+                        const float dx = px + 0.5f - cx;
+                        row[px] = dx * dx + dy2 <= r2 ? c : row[px];
+                    }
+                }
+            }
+        }
+    }
+};
+
+//Formato de salida de FrameWriter, según el nombre del archivo.
+enum FrameFormat {
+    FRAME_PPM,    // .ppm (o cualquier otra extensión)
+    FRAME_PNG,    // .png, sin comprimir
+    FRAME_RAW     // .raw o "-": video RGB24 crudo, todos los frames seguidos
+};
+
+//Crc32
+//3 Parametros
+//CRC-32 de PNG (polinomio 0xEDB88320) de size bytes, continuando desde crc.
+//Retorno el CRC actualizado
+inline uint32_t Crc32(uint32_t crc, const unsigned char* data, size_t size) {
+    static const std::array<uint32_t, 256> table = [] { //Sin heap: se crea al guardar el primer PNG, que puede ser el último frame
+        std::array<uint32_t, 256> values;
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            values[n] = c;
+        }
+        return values;
+    }();
+    crc = ~crc;
+    for (size_t k = 0; k < size; k++) crc = table[(crc ^ data[k]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+//FrameNumberFormats
+//1 Parametro
+//Cuenta las conversiones %d o %0Nd de file, el nombre que Write usa como formato de printf.
+//Fuera de ellas solo se acepta %% (un % literal).
+//Retorno la cantidad de conversiones, o -1 si hay otra conversión
+inline int FrameNumberFormats(const char* file) {
+    int conversions = 0;
+    for (const char* c = file; *c != '\0'; c++) {
+        if (*c != '%') continue;
+        c++;
+        if (*c == '%') continue;
+        if (*c == '0') c++;
+        while (*c >= '0' && *c <= '9') c++;
+        if (*c != 'd') return -1;
+        conversions++;
+    }
+    return conversions;
+}
+
+//Escribe las imágenes de SoftwareRenderer: un archivo por frame si el nombre tiene un
+//formato de printf (frame_%05d.ppm), solo el último frame si no lo tiene, o un video crudo
+//con todos los frames (.raw, o "-" para la salida estándar, por ejemplo hacia ffmpeg).
+struct FrameWriter {
+    const char* path = nullptr;
+    FrameFormat format = FRAME_PPM;
+    bool perFrame = false;
+    std::FILE* stream = nullptr;        // Video crudo abierto
+    std::vector<unsigned char> rgb;     // Frame en RGB, con el byte de filtro por fila en PNG
+    std::vector<unsigned char> encoded; // PNG completo
+    std::vector<unsigned char> zlib;    // Flujo zlib del chunk IDAT
+
+    bool Enabled() const { return path != nullptr; }
+
+    //Wants
+    //2 Parametros
+    //Indica si hay que guardar el frame number de total (sin formato de printf solo se
+    //guarda el último).
+    //Retorno verdadero si hay que llamar Write
+    bool Wants(int number, int total) const {
+        return Enabled() && (format == FRAME_RAW || perFrame || number == total - 1);
+    }
+
+    //Open
+    //3 Parametros
+    //Prepara la salida en file para imágenes de w x h. Un nombre con % debe tener un solo
+    //%d (o %0Nd) para el número de frame; cualquier otra conversión se rechaza.
+    //Retorno verdadero si se pudo abrir
+    bool Open(const char* file, int w, int h) {
+        const size_t length = std::strlen(file);
+        const bool raw = std::strcmp(file, "-") == 0 || (length >= 4 && std::strcmp(file + length - 4, ".raw") == 0);
+        const int conversions = FrameNumberFormats(file);
+        if (!raw && (conversions < 0 || conversions > 1)) {
+            std::cout << "--output acepta un solo %d (o %0Nd) para el número de frame y %% para un % literal.\n";
+            return false;
+        }
+        path = file;
+        format = raw ? FRAME_RAW : (length >= 4 && std::strcmp(file + length - 4, ".png") == 0) ? FRAME_PNG : FRAME_PPM;
+        perFrame = !raw && conversions == 1;
+        rgb.resize(static_cast<size_t>(w) * h * 3 + (format == FRAME_PNG ? h : 0));
+        if (format == FRAME_PNG) {
+            //Tamaños exactos del PNG, así EncodePng no reserva memoria en cada frame.
+            zlib.reserve(2 + rgb.size() + 5 * ((rgb.size() + 65534) / 65535) + 4);
+            encoded.reserve(8 + (12 + 13) + (12 + zlib.capacity()) + 12);
+        }
+        if (raw) {
+            stream = std::strcmp(file, "-") == 0 ? stdout : std::fopen(file, "wb");
+            if (stream == nullptr) {
+                path = nullptr;
+                return false;
+            }
+            std::cerr << "Video RGB24 de " << w << "x" << h << ": ffmpeg -f rawvideo -pix_fmt rgb24 -s " << w << "x" << h
+                      << " -r 60 -i " << file << " salida.mp4\n";
+        }
+        return true;
+    }
+
+    //ToRgb
+    //1 Parametro
+    //Copia la imagen RGBA a rgb (sin alfa); en PNG cada fila empieza con el filtro 0.
+    //Retorno nulo
+    void ToRgb(const SoftwareRenderer& image) {
+        const int rowPrefix = format == FRAME_PNG ? 1 : 0;
+        unsigned char* out = rgb.data();
+        for (int y = 0; y < image.height; y++) {
+            if (rowPrefix) *out++ = 0;
+            const uint32_t* row = &image.pixels[static_cast<size_t>(y) * image.width];
+            for (int x = 0; x < image.width; x++) {
+                out[0] = static_cast<unsigned char>(row[x]);
+                out[1] = static_cast<unsigned char>(row[x] >> 8);
+                out[2] = static_cast<unsigned char>(row[x] >> 16);
+                out += 3;
+            }
+        }
+    }
+
+    //EncodePng
+    //2 Parametros
+    //Arma un PNG RGB de 8 bits con las filas de rgb en bloques deflate sin comprimir, para
+    //no depender de zlib.
+    //Retorno nulo
+    void EncodePng(int w, int h) {
+        auto put32 = [this](uint32_t value) {
+            for (int shift = 24; shift >= 0; shift -= 8) encoded.push_back(static_cast<unsigned char>(value >> shift));
+        };
+        auto chunk = [&](const char* type, const unsigned char* data, size_t size) {
+            put32(static_cast<uint32_t>(size));
+            const size_t start = encoded.size();
+            encoded.insert(encoded.end(), type, type + 4);
+            encoded.insert(encoded.end(), data, data + size);
+            put32(Crc32(0, &encoded[start], size + 4));
+        };
+
+        encoded.clear();
+        const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        encoded.insert(encoded.end(), signature, signature + 8);
+        const unsigned char header[13] = { static_cast<unsigned char>(w >> 24), static_cast<unsigned char>(w >> 16), static_cast<unsigned char>(w >> 8), static_cast<unsigned char>(w),
+                                           static_cast<unsigned char>(h >> 24), static_cast<unsigned char>(h >> 16), static_cast<unsigned char>(h >> 8), static_cast<unsigned char>(h),
+                                           8, 2, 0, 0, 0 }; // 8 bits, RGB
+        chunk("IHDR", header, sizeof(header));
+
+        //Flujo zlib: encabezado, bloques "stored" de hasta 65535 bytes y Adler-32.
+        zlib.assign({ 0x78, 0x01 });
+        uint32_t a = 1, b = 0;
+        for (size_t pos = 0; pos < rgb.size();) {
+            const size_t size = std::min<size_t>(65535, rgb.size() - pos);
+            zlib.push_back(pos + size == rgb.size() ? 1 : 0);
+            zlib.push_back(static_cast<unsigned char>(size));
+            zlib.push_back(static_cast<unsigned char>(size >> 8));
+            zlib.push_back(static_cast<unsigned char>(~size));
+            zlib.push_back(static_cast<unsigned char>(~size >> 8));
+            zlib.insert(zlib.end(), rgb.begin() + pos, rgb.begin() + pos + size);
+            for (size_t k = pos; k < pos + size; k++) {
+                a = (a + rgb[k]) % 65521;
+                b = (b + a) % 65521;
+            }
+            pos += size;
+        }
+        for (int shift = 24; shift >= 0; shift -= 8) zlib.push_back(static_cast<unsigned char>(((b << 16) | a) >> shift));
+        chunk("IDAT", zlib.data(), zlib.size());
+        chunk("IEND", nullptr, 0);
+    }
+
+    //Write
+    //2 Parametros
+    //Guarda el frame number de image según el formato.
+    //Retorno verdadero si se pudo escribir
+    bool Write(const SoftwareRenderer& image, int number) {
+        ToRgb(image);
+        if (format == FRAME_RAW) {
+            return std::fwrite(rgb.data(), 1, rgb.size(), stream) == rgb.size();
+        }
+
+        char name[512];
+        std::snprintf(name, sizeof(name), path, number); //Open ya revisó que solo tenga %d o %%
+        std::FILE* file = std::fopen(name, "wb");
+        if (file == nullptr) return false;
+        bool ok;
+        if (format == FRAME_PNG) {
+            EncodePng(image.width, image.height);
+            ok = std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+        } else {
+            ok = std::fprintf(file, "P6\n%d %d\n255\n", image.width, image.height) > 0
+                 && std::fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+        }
+        return (std::fclose(file) == 0) && ok;
+    }
+
+    //Close
+    //0 Parametros
+    //Cierra el video crudo.
+    //Retorno nulo
+    void Close() {
+        if (stream != nullptr && stream != stdout) std::fclose(stream);
+        if (stream == stdout) std::fflush(stdout);
+        stream = nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef RELOJ_H
+#define RELOJ_H
+
+#include <chrono>
+#include <cmath>
+#include <atomic> // Librerías que importar
+
+const int MAX_SUBSTEPS_PER_FRAME = 8;     //Si la simulación no alcanza al tiempo real se descarta el resto, en vez de atrasarse cada vez más.
+const double MAX_FRAME_SECONDS = 0.25;    //Un frame más largo (ventana arrastrada, depurador) cuenta solo como esto.
+
+//Reloj de paso fijo. El tiempo real entre frames se acumula y se consume en pasos de
+//simulación de duración fija, así el movimiento no depende de los FPS. Lo que sobra
+//(menos de un paso) sirve para interpolar el dibujo entre los dos últimos estados.
+//Advance() lo llama solo el hilo que simula; Seconds() e InterpolationFactor() se pueden
+//llamar desde el hilo que dibuja.
+struct SimulationClock {
+    typedef std::chrono::steady_clock Clock;
+
+    double step = 1.0 / 60.0;   // Segundos simulados por paso
+    double accumulator = 0.0;   // Tiempo real aún no simulado
+    std::atomic<double> discarded{0.0}; // Tiempo real descartado (frames largos o simulación atrasada)
+    Clock::time_point origin;
+    Clock::time_point last;
+
+    //Start
+    //1 Parametro
+    //Reinicia el reloj con pasos de stepSeconds segundos.
+    //Retorno nulo
+    void Start(double stepSeconds) {
+        step = stepSeconds;
+        accumulator = 0.0;
+        discarded.store(0.0, std::memory_order_relaxed);
+        origin = Clock::now();
+        last = origin;
+    }
+
+    //Advance
+    //0 Parametros
+    //Suma el tiempo real desde la llamada anterior y saca de él los pasos completos.
+    //Retorno la cantidad de subpasos que hay que simular ahora (puede ser 0)
+    int Advance() {
+        const Clock::time_point now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - last).count();
+        last = now;
+        double dropped = 0.0;
+        if (elapsed > MAX_FRAME_SECONDS) {
+            dropped = elapsed - MAX_FRAME_SECONDS;
+            elapsed = MAX_FRAME_SECONDS;
+        }
+        accumulator += elapsed;
+
+        int substeps = static_cast<int>(accumulator / step);
+        if (substeps > MAX_SUBSTEPS_PER_FRAME) {
+            substeps = MAX_SUBSTEPS_PER_FRAME;
+            const double kept = substeps * step + std::fmod(accumulator, step);
+            dropped += accumulator - kept;
+            accumulator = kept;
+        }
+        accumulator -= substeps * step;
+        if (dropped > 0.0) {
+            discarded.store(discarded.load(std::memory_order_relaxed) + dropped, std::memory_order_relaxed);
+        }
+        return substeps;
+    }
+
+    //TimeToNextStep
+    //0 Parametros
+    //Tiempo real que falta para que haya un paso completo que simular.
+    //Retorno los segundos de espera
+    double TimeToNextStep() const {
+        return step - accumulator;
+    }
+
+    //Seconds
+    //0 Parametros
+    //Tiempo real desde Start() sin lo descartado. Coincide con los segundos simulados más
+    //lo acumulado, así sirve para ubicar cualquier estado en el tiempo.
+    //Retorno los segundos
+    double Seconds() const {
+        const double real = std::chrono::duration<double>(Clock::now() - origin).count();
+        return real - discarded.load(std::memory_order_relaxed);
+    }
+
+    //InterpolationFactor
+    //2 Parametros
+    //Fracción entre la posición anterior (0) y la actual (1) de un estado que termina en
+    //stateTime y viene de una tanda de batchTime segundos, para dibujarlo en el tiempo real
+    //atrasado un paso. Con un solo hilo equivale a 1 - (1 - resto/paso) / subpasos.
+    //Retorno la fracción en [0, 1]
+    float InterpolationFactor(double stateTime, double batchTime) const {
+        if (batchTime <= 0.0) return 1.0f;
+        const double t = (Seconds() - step - (stateTime - batchTime)) / batchTime;
+        return static_cast<float>(t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t));
+    }
+};
+
+#endif
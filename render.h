@@ -0,0 +1,586 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <GL/freeglut.h>
+#include <GL/glext.h>
+#include <omp.h>
+#include "particulas.h"
+#include "perfil.h" // Librerías que importar
+
+//Funciones de OpenGL 3.x/4.x que no exporta gl.h. Se cargan en tiempo de ejecución con
+//glutGetProcAddress para poder caer al modo legacy si el contexto no las tiene.
+#define RENDER_GL_FUNCTIONS(X) \
+    X(PFNGLGENBUFFERSPROC, GenBuffers) \
+    X(PFNGLBINDBUFFERPROC, BindBuffer) \
+    X(PFNGLBUFFERDATAPROC, BufferData) \
+    X(PFNGLBUFFERSUBDATAPROC, BufferSubData) \
+    X(PFNGLMAPBUFFERRANGEPROC, MapBufferRange) \
+    X(PFNGLGENVERTEXARRAYSPROC, GenVertexArrays) \
+    X(PFNGLBINDVERTEXARRAYPROC, BindVertexArray) \
+    X(PFNGLENABLEVERTEXATTRIBARRAYPROC, EnableVertexAttribArray) \
+    X(PFNGLVERTEXATTRIBPOINTERPROC, VertexAttribPointer) \
+    X(PFNGLVERTEXATTRIBDIVISORPROC, VertexAttribDivisor) \
+    X(PFNGLDRAWARRAYSINSTANCEDPROC, DrawArraysInstanced) \
+    X(PFNGLCREATESHADERPROC, CreateShader) \
+    X(PFNGLSHADERSOURCEPROC, ShaderSource) \
+    X(PFNGLCOMPILESHADERPROC, CompileShader) \
+    X(PFNGLGETSHADERIVPROC, GetShaderiv) \
+    X(PFNGLGETSHADERINFOLOGPROC, GetShaderInfoLog) \
+    X(PFNGLCREATEPROGRAMPROC, CreateProgram) \
+    X(PFNGLATTACHSHADERPROC, AttachShader) \
+    X(PFNGLBINDATTRIBLOCATIONPROC, BindAttribLocation) \
+    X(PFNGLLINKPROGRAMPROC, LinkProgram) \
+    X(PFNGLGETPROGRAMIVPROC, GetProgramiv) \
+    X(PFNGLGETPROGRAMINFOLOGPROC, GetProgramInfoLog) \
+    X(PFNGLUSEPROGRAMPROC, UseProgram) \
+    X(PFNGLGETUNIFORMLOCATIONPROC, GetUniformLocation) \
+    X(PFNGLUNIFORM2FPROC, Uniform2f)
+
+//Opcionales: buffer persistente (GL 4.4 / ARB_buffer_storage) con fences.
+#define RENDER_GL_OPTIONAL(X) \
+    X(PFNGLBUFFERSTORAGEPROC, BufferStorage) \
+    X(PFNGLFENCESYNCPROC, FenceSync) \
+    X(PFNGLCLIENTWAITSYNCPROC, ClientWaitSync) \
+    X(PFNGLDELETESYNCPROC, DeleteSync)
+
+struct GLFunctions {
+#define RENDER_DECLARE(type, name) type name = nullptr;
+    RENDER_GL_FUNCTIONS(RENDER_DECLARE)
+    RENDER_GL_OPTIONAL(RENDER_DECLARE)
+#undef RENDER_DECLARE
+
+    int version = 0;            // Versión del contexto como mayor * 10 + menor
+    bool bufferStorage = false; // GL 4.4 o ARB_buffer_storage
+
+    //ContextVersion
+    //0 Parametros
+    //Lee la versión del contexto actual de glGetString(GL_VERSION).
+    //Retorno la versión como mayor * 10 + menor, 0 si no se puede leer
+    static int ContextVersion() {
+        const char* text = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+        int major = 0, minor = 0;
+        if (text == nullptr || std::sscanf(text, "%d.%d", &major, &minor) != 2) return 0;
+        return major * 10 + minor;
+    }
+
+    //Load
+    //0 Parametros
+    //Carga los punteros a funciones del contexto actual.
+    //Retorno verdadero si están todas las funciones obligatorias
+    bool Load() {
+        //En GLX glutGetProcAddress devuelve punteros aun si el contexto no soporta la
+        //función, así que primero se revisa la versión del contexto.
+        version = ContextVersion();
+        const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+        bufferStorage = version >= 44 || (extensions != nullptr && std::strstr(extensions, "GL_ARB_buffer_storage") != nullptr);
+        if (version < 33) return false;
+
+        bool complete = true;
+#define RENDER_LOAD(type, name) name = reinterpret_cast<type>(glutGetProcAddress("gl" #name)); complete = complete && name != nullptr;
+        RENDER_GL_FUNCTIONS(RENDER_LOAD)
+#undef RENDER_LOAD
+#define RENDER_LOAD_OPTIONAL(type, name) name = reinterpret_cast<type>(glutGetProcAddress("gl" #name));
+        RENDER_GL_OPTIONAL(RENDER_LOAD_OPTIONAL)
+#undef RENDER_LOAD_OPTIONAL
+        return complete;
+    }
+
+    bool HasPersistentMapping() const {
+        return bufferStorage && BufferStorage != nullptr && FenceSync != nullptr && ClientWaitSync != nullptr && DeleteSync != nullptr;
+    }
+};
+
+const int INSTANCE_FLOATS = 6; //Por partícula: x, y, radio, r, g, b.
+const float LOD_POINT_PIXELS = 1.0f; //Radio en pantalla bajo el que un círculo se dibuja como punto.
+const int MIN_FAN_SEGMENTS = 8;
+const int MAX_FAN_SEGMENTS = 64;     //Segmentos del dibujo original.
+const int RING_REGIONS = 3;    //Regiones del buffer persistente (una se escribe mientras la GPU lee las otras).
+
+//Cada círculo es un cuadrado instanciado; el fragment shader descarta lo que queda fuera
+//del disco unitario. Compatible con GLSL 1.30, que soporta llvmpipe (Mesa) sin GPU.
+const char* const INSTANCED_VERTEX_SHADER =
+    "#version 130\n"
+    "in vec2 corner;\n"
+    "in vec3 instance;\n"      // x, y, radio
+    "in vec3 instanceColor;\n"
+    "uniform vec2 scale;\n"     // 2 / tamaño de la ventana
+    "out vec2 local;\n"
+    "out vec3 color;\n"
+    "void main() {\n"
+    "    local = corner;\n"
+    "    color = instanceColor;\n"
+    "    gl_Position = vec4((instance.xy + corner * instance.z) * scale, 0.0, 1.0);\n"
+    "}\n";
+
+const char* const INSTANCED_FRAGMENT_SHADER =
+    "#version 130\n"
+    "in vec2 local;\n"
+    "in vec3 color;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    if (dot(local, local) > 1.0) discard;\n"
+    "    fragColor = vec4(color, 1.0);\n"
+    "}\n";
+
+//PackInstances
+//3 Parametros
+//Copia posición, radio y color de las partículas al formato intercalado del buffer de
+//instancias. La posición se interpola entre previousX/Y y posX/Y con la fracción t del
+//reloj de simulación. Corre en un solo hilo, el de GLUT: en paralela.cpp el equipo de
+//OpenMP está simulando en su propio hilo mientras tanto.
+//Retorno nulo
+inline void PackInstances(float* dst, const ParticleSystem& current, float t) {
+    const int n = current.count;
+    for (int i = 0; i < n; i++) {
+        float* out = dst + static_cast<size_t>(i) * INSTANCE_FLOATS;
+        out[0] = current.previousX[i] + (current.posX[i] - current.previousX[i]) * t;
+        out[1] = current.previousY[i] + (current.posY[i] - current.previousY[i]) * t;
+        out[2] = current.radius[i];
+        out[3] = current.colorR[i];
+        out[4] = current.colorG[i];
+        out[5] = current.colorB[i];
+    }
+}
+
+//Renderizador en modo retenido: los datos de las partículas se suben una vez por frame a
+//un vertex buffer y se dibujan todos los círculos con una sola llamada instanciada.
+struct InstancedRenderer {
+    GLFunctions gl;
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint quadBuffer = 0;
+    GLuint instanceBuffer = 0;
+    GLint scaleLocation = -1;
+
+    int capacity = 0;              // Partículas que caben en una región del buffer
+    bool persistent = false;       // Buffer mapeado de forma persistente
+    float* mapped = nullptr;       // Memoria mapeada (las RING_REGIONS regiones)
+    GLsync fences[RING_REGIONS] = {};
+    int region = 0;
+
+    std::vector<float> staging;    // Copia en CPU cuando no hay mapeo persistente
+    float* current = nullptr;      // Destino de la subida del frame actual
+    int uploaded = 0;
+
+    //CompileShader
+    //2 Parametros
+    //Compila un shader y muestra el log si falla.
+    //Retorno el identificador del shader, 0 si falla
+    GLuint CompileShader(GLenum type, const char* source) {
+        GLuint shader = gl.CreateShader(type);
+        gl.ShaderSource(shader, 1, &source, nullptr);
+        gl.CompileShader(shader);
+        GLint ok = GL_FALSE;
+        gl.GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (ok != GL_TRUE) {
+            char log[1024];
+            gl.GetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            std::cout << "Error compilando shader: " << log << "\n";
+            return 0;
+        }
+        return shader;
+    }
+
+    //Init
+    //1 Parametro
+    //Crea los shaders y buffers para hasta maxParticles partículas. Necesita un contexto
+    //de OpenGL activo (después de glutCreateWindow).
+    //Retorno verdadero si el renderizador quedó listo
+    bool Init(int maxParticles) {
+        if (!gl.Load()) {
+            std::cout << "El contexto de OpenGL (" << gl.version / 10 << "." << gl.version % 10 << ") no soporta dibujo instanciado.\n";
+            return false;
+        }
+
+        GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, INSTANCED_VERTEX_SHADER);
+        GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, INSTANCED_FRAGMENT_SHADER);
+        if (vertexShader == 0 || fragmentShader == 0) return false;
+
+        program = gl.CreateProgram();
+        gl.AttachShader(program, vertexShader);
+        gl.AttachShader(program, fragmentShader);
+        gl.BindAttribLocation(program, 0, "corner");
+        gl.BindAttribLocation(program, 1, "instance");
+        gl.BindAttribLocation(program, 2, "instanceColor");
+        gl.LinkProgram(program);
+        GLint ok = GL_FALSE;
+        gl.GetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (ok != GL_TRUE) {
+            char log[1024];
+            gl.GetProgramInfoLog(program, sizeof(log), nullptr, log);
+            std::cout << "Error enlazando shaders: " << log << "\n";
+            return false;
+        }
+        scaleLocation = gl.GetUniformLocation(program, "scale");
+
+        //Malla unitaria: un cuadrado de [-1, 1] como triangle strip.
+        const float quad[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+        gl.GenVertexArrays(1, &vao);
+        gl.BindVertexArray(vao);
+        gl.GenBuffers(1, &quadBuffer);
+        gl.BindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+        gl.BufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        gl.EnableVertexAttribArray(0);
+        gl.VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+        capacity = maxParticles > 0 ? maxParticles : 1;
+        const GLsizeiptr regionBytes = static_cast<GLsizeiptr>(capacity) * INSTANCE_FLOATS * sizeof(float);
+        gl.GenBuffers(1, &instanceBuffer);
+        gl.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+        persistent = gl.HasPersistentMapping();
+        if (persistent) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            gl.BufferStorage(GL_ARRAY_BUFFER, regionBytes * RING_REGIONS, nullptr, flags);
+            mapped = static_cast<float*>(gl.MapBufferRange(GL_ARRAY_BUFFER, 0, regionBytes * RING_REGIONS, flags));
+            persistent = mapped != nullptr;
+        }
+        if (!persistent) {
+            gl.BufferData(GL_ARRAY_BUFFER, regionBytes, nullptr, GL_STREAM_DRAW);
+            staging.resize(static_cast<size_t>(capacity) * INSTANCE_FLOATS);
+        }
+
+        gl.EnableVertexAttribArray(1);
+        gl.EnableVertexAttribArray(2);
+        gl.VertexAttribDivisor(1, 1);
+        gl.VertexAttribDivisor(2, 1);
+
+        gl.BindVertexArray(0);
+        gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+        std::cout << "Renderizador instanciado listo (" << (persistent ? "buffer persistente" : "glBufferSubData") << ").\n";
+        return true;
+    }
+
+    //BeginUpload
+    //1 Parametro
+    //Devuelve dónde escribir los datos de las partículas para este frame. Con el buffer
+    //persistente espera a que la GPU haya terminado de leer la región que se va a reusar.
+    //Retorno puntero al destino de PackInstances
+    float* BeginUpload(int n) {
+        uploaded = n < capacity ? n : capacity;
+        if (persistent) {
+            if (fences[region] != nullptr) {
+                gl.ClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+                gl.DeleteSync(fences[region]);
+                fences[region] = nullptr;
+            }
+            current = mapped + static_cast<size_t>(region) * capacity * INSTANCE_FLOATS;
+        } else {
+            current = staging.data();
+        }
+        return current;
+    }
+
+    //Draw
+    //0 Parametros
+    //Termina la subida y dibuja todas las partículas con una llamada instanciada.
+    //Retorno nulo
+    void Draw() {
+        const size_t instanceBytes = INSTANCE_FLOATS * sizeof(float);
+        size_t offset = 0;
+
+        gl.BindVertexArray(vao);
+        gl.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        if (persistent) {
+            offset = static_cast<size_t>(region) * capacity * instanceBytes;
+        } else {
+            //Orphaning: se pide memoria nueva para no esperar a que la GPU suelte la anterior.
+            gl.BufferData(GL_ARRAY_BUFFER, capacity * instanceBytes, nullptr, GL_STREAM_DRAW);
+            gl.BufferSubData(GL_ARRAY_BUFFER, 0, uploaded * instanceBytes, staging.data());
+        }
+        gl.VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, instanceBytes, reinterpret_cast<const void*>(offset));
+        gl.VertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, instanceBytes, reinterpret_cast<const void*>(offset + 3 * sizeof(float)));
+
+        gl.UseProgram(program);
+        gl.Uniform2f(scaleLocation, 2.0f / WINDOW_WIDTH, 2.0f / WINDOW_HEIGHT);
+        gl.DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, uploaded);
+        gl.UseProgram(0);
+        gl.BindVertexArray(0);
+        gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+        if (persistent) {
+            fences[region] = gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            region = (region + 1) % RING_REGIONS;
+        }
+    }
+};
+
+//FanSegments
+//1 Parametro
+//Segmentos del abanico para que la cuerda se aleje menos de medio píxel del círculo de
+//radiusPixels píxeles en pantalla (nivel de detalle).
+//Retorno la cantidad de segmentos, entre MIN_FAN_SEGMENTS y MAX_FAN_SEGMENTS
+inline int FanSegments(float radiusPixels) {
+    if (radiusPixels <= 0.5f) return MIN_FAN_SEGMENTS;
+    const int segments = static_cast<int>(std::ceil(M_PI / std::acos(1.0f - 0.5f / radiusPixels)));
+    return std::min(std::max(segments, MIN_FAN_SEGMENTS), MAX_FAN_SEGMENTS);
+}
+
+//Tabla del círculo unitario: para cada cantidad de segmentos n entre MIN_FAN_SEGMENTS y
+//MAX_FAN_SEGMENTS guarda cos y sin de j * 2π / n, j = 0..n (el último repite el primero
+//para cerrar el abanico). Se calcula una sola vez en vez de 2 * (n + 1) funciones
+//trigonométricas por partícula y frame.
+struct CircleTable {
+    static const int SIZE = (MAX_FAN_SEGMENTS + 1) * (MAX_FAN_SEGMENTS + 2) / 2 - MIN_FAN_SEGMENTS * (MIN_FAN_SEGMENTS + 1) / 2;
+    float cosines[SIZE];
+    float sines[SIZE];
+    int offset[MAX_FAN_SEGMENTS + 1] = {};
+
+    CircleTable() {
+        int k = 0;
+        for (int n = MIN_FAN_SEGMENTS; n <= MAX_FAN_SEGMENTS; n++) {
+            offset[n] = k;
+            for (int j = 0; j <= n; j++, k++) {
+                const double angle = j * 2.0 * M_PI / n;
+                cosines[k] = static_cast<float>(std::cos(angle));
+                sines[k] = static_cast<float>(std::sin(angle));
+            }
+        }
+    }
+
+    const float* Cos(int segments) const { return cosines + offset[segments]; }
+    const float* Sin(int segments) const { return sines + offset[segments]; }
+};
+
+//UnitCircle
+//0 Parametros
+//Tabla compartida del círculo unitario (se crea la primera vez que se usa).
+//Retorno la tabla
+inline const CircleTable& UnitCircle() {
+    static const CircleTable table;
+    return table;
+}
+
+//ViewportScale
+//0 Parametros
+//Píxeles de pantalla por unidad del mundo, por si la ventana cambió de tamaño.
+//Retorno la escala
+inline float ViewportScale() {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    return static_cast<float>(viewport[2]) / WINDOW_WIDTH;
+}
+
+//Vértice del dibujo por abanicos: posición y color en 12 bytes.
+struct FanVertex {
+    float x, y;
+    GLubyte r, g, b, a;
+};
+
+//Renderizador por abanicos en CPU: el mismo dibujo que el legacy (un GL_TRIANGLE_FAN por
+//partícula, puntos para las pequeñas), pero los vértices los genera el equipo de OpenMP en
+//arreglos que se reutilizan entre frames, con la tabla del círculo unitario, y se envían con
+//una sola llamada a glMultiDrawArrays en vez de una llamada a glVertex por vértice. Sirve
+//para medir cuánto cuesta el envío desde la CPU contra el modo inmediato.
+struct FanRenderer {
+    PFNGLMULTIDRAWARRAYSPROC MultiDrawArrays = nullptr;
+    std::vector<FanVertex> vertices;  // Abanicos de todas las partículas, seguidos
+    std::vector<FanVertex> points;    // Partículas de menos de LOD_POINT_PIXELS de radio
+    std::vector<GLint> first;         // Primer vértice del abanico de cada partícula
+    std::vector<GLsizei> count;       // Vértices del abanico de cada partícula (0 si es punto)
+    std::vector<int> threadVertices;  // Vértices y puntos por hilo, luego sus inicios
+    std::vector<int> threadPoints;
+    int numPoints = 0;
+
+    //Init
+    //0 Parametros
+    //Carga glMultiDrawArrays (OpenGL 1.4); sin ella se dibuja un abanico por llamada
+    //con glDrawArrays, desde los mismos arreglos.
+    //Retorno nulo
+    void Init() {
+        if (GLFunctions::ContextVersion() >= 14) {
+            MultiDrawArrays = reinterpret_cast<PFNGLMULTIDRAWARRAYSPROC>(glutGetProcAddress("glMultiDrawArrays"));
+        }
+        std::cout << "Renderizador de abanicos listo (" << (MultiDrawArrays != nullptr ? "glMultiDrawArrays" : "glDrawArrays por partícula") << ").\n";
+    }
+
+    //Build
+    //3 Parametros
+    //Genera los vértices de todas las partículas con la posición interpolada con t. Debe
+    //llamarse desde todos los hilos del equipo (o fuera de una región paralela). Cada hilo
+    //cuenta los vértices de un bloque contiguo de partículas, una suma prefija por hilo da
+    //dónde escribe cada uno, y cada hilo llena su bloque sin sincronizarse con los demás.
+    //Los arreglos solo crecen, así que después de los primeros frames no se reserva memoria.
+    //Retorno nulo
+    void Build(const ParticleSystem& particles, float t, float pixelsPerUnit) {
+        const int n = particles.count;
+        const int tid = omp_get_thread_num();
+        const int numThreads = omp_get_num_threads();
+        const CircleTable& circle = UnitCircle();
+
+        #pragma omp single
+        {
+            first.resize(n);
+            count.resize(n);
+            threadVertices.assign(numThreads + 1, 0);
+            threadPoints.assign(numThreads + 1, 0);
+        }
+
+        const int begin = static_cast<int>(static_cast<long long>(n) * tid / numThreads);
+        const int end = static_cast<int>(static_cast<long long>(n) * (tid + 1) / numThreads);
+
+        //Conteo: centro más segmentos + 1 vértices del borde, o un punto.
+        int myVertices = 0, myPoints = 0;
+        for (int i = begin; i < end; i++) {
+            const float radiusPixels = particles.radius[i] * pixelsPerUnit;
+            if (radiusPixels < LOD_POINT_PIXELS) {
+                count[i] = 0;
+                myPoints++;
+            } else {
+                count[i] = FanSegments(radiusPixels) + 2;
+                myVertices += count[i];
+            }
+        }
+        threadVertices[tid + 1] = myVertices;
+        threadPoints[tid + 1] = myPoints;
+        #pragma omp barrier
+
+        #pragma omp single
+        {
+            for (int k = 0; k < numThreads; k++) {
+                threadVertices[k + 1] += threadVertices[k];
+                threadPoints[k + 1] += threadPoints[k];
+            }
+            if (vertices.size() < static_cast<size_t>(threadVertices[numThreads])) vertices.resize(threadVertices[numThreads]);
+            if (points.size() < static_cast<size_t>(threadPoints[numThreads])) points.resize(threadPoints[numThreads]);
+            numPoints = threadPoints[numThreads];
+        }
+
+        //Llenado del bloque de este hilo.
+        int v = threadVertices[tid];
+        int p = threadPoints[tid];
+        for (int i = begin; i < end; i++) {
+            const float x = particles.previousX[i] + (particles.posX[i] - particles.previousX[i]) * t;
+            const float y = particles.previousY[i] + (particles.posY[i] - particles.previousY[i]) * t;
+            const GLubyte r = static_cast<GLubyte>(particles.colorR[i] * 255.0f + 0.5f);
+            const GLubyte g = static_cast<GLubyte>(particles.colorG[i] * 255.0f + 0.5f);
+            const GLubyte b = static_cast<GLubyte>(particles.colorB[i] * 255.0f + 0.5f);
+            first[i] = v;
+            if (count[i] == 0) {
+                points[p++] = FanVertex{ x, y, r, g, b, 255 };
+                continue;
+            }
+            const int segments = count[i] - 2;
+            const float* cosines = circle.Cos(segments);
+            const float* sines = circle.Sin(segments);
+            const float radius = particles.radius[i];
+            FanVertex* out = &vertices[v];
+            out[0] = FanVertex{ x, y, r, g, b, 255 };
+            for (int j = 0; j <= segments; j++) {
+                out[j + 1] = FanVertex{ x + radius * cosines[j], y + radius * sines[j], r, g, b, 255 };
+            }
+            v += count[i];
+        }
+        #pragma omp barrier
+    }
+
+    //Draw
+    //0 Parametros
+    //Envía los abanicos generados por Build y después los puntos.
+    //Retorno nulo
+    void Draw() {
+        const int n = static_cast<int>(count.size());
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        if (!vertices.empty()) {
+            glVertexPointer(2, GL_FLOAT, sizeof(FanVertex), &vertices[0].x);
+            glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(FanVertex), &vertices[0].r);
+            if (MultiDrawArrays != nullptr) {
+                MultiDrawArrays(GL_TRIANGLE_FAN, first.data(), count.data(), n);
+            } else {
+                for (int i = 0; i < n; i++) {
+                    if (count[i] > 0) glDrawArrays(GL_TRIANGLE_FAN, first[i], count[i]);
+                }
+            }
+        }
+        if (numPoints > 0) {
+            glPointSize(2.0f * LOD_POINT_PIXELS);
+            glVertexPointer(2, GL_FLOAT, sizeof(FanVertex), &points[0].x);
+            glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(FanVertex), &points[0].r);
+            glDrawArrays(GL_POINTS, 0, numPoints);
+        }
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+    }
+};
+
+//DrawParticlesLegacy
+//2 Parametros
+//Dibujo en modo inmediato original: un GL_TRIANGLE_FAN por partícula, con la posición
+//interpolada igual que en PackInstances y los ángulos de la tabla del círculo unitario. La cantidad de segmentos depende del tamaño en
+//pantalla, y los círculos de menos de LOD_POINT_PIXELS de radio se dibujan juntos como
+//puntos, para que millones de partículas sigan siendo interactivas.
+//Se mantiene para comparar contra el renderizador instanciado.
+//Retorno nulo
+inline void DrawParticlesLegacy(const ParticleSystem& particles, float t) {
+    const float pixelsPerUnit = ViewportScale();
+    const CircleTable& circle = UnitCircle();
+    bool hasPoints = false;
+
+    for (int i = 0; i < particles.count; i++) {
+        const float radiusPixels = particles.radius[i] * pixelsPerUnit;
+        if (radiusPixels < LOD_POINT_PIXELS) {
+            hasPoints = true;
+            continue;
+        }
+        const float x = particles.previousX[i] + (particles.posX[i] - particles.previousX[i]) * t;
+        const float y = particles.previousY[i] + (particles.posY[i] - particles.previousY[i]) * t;
+        // Dibujar el cuerpo (un círculo grande). Se empiezan a crear.
+        glColor3f(particles.colorR[i], particles.colorG[i], particles.colorB[i]);
+        glBegin(GL_TRIANGLE_FAN);
+        glVertex2f(x, y);
+        const int numSegments = FanSegments(radiusPixels);
+        const float* cosines = circle.Cos(numSegments);  //Ángulos precalculados
+        const float* sines = circle.Sin(numSegments);
+        for (int j = 0; j <= numSegments; j++) {
+            float dx = particles.radius[i] * cosines[j];
+            float dy = particles.radius[i] * sines[j];
+
+            glVertex2f(x + dx, y + dy);
+        }
+        glEnd();
+    }
+
+    if (hasPoints) {
+        //Las partículas pequeñas en una sola lista de puntos de 2 píxeles.
+        glPointSize(2.0f * LOD_POINT_PIXELS);
+        glBegin(GL_POINTS);
+        for (int i = 0; i < particles.count; i++) {
+            if (particles.radius[i] * pixelsPerUnit >= LOD_POINT_PIXELS) continue;
+            glColor3f(particles.colorR[i], particles.colorG[i], particles.colorB[i]);
+            glVertex2f(particles.previousX[i] + (particles.posX[i] - particles.previousX[i]) * t,
+                       particles.previousY[i] + (particles.posY[i] - particles.previousY[i]) * t);
+        }
+        glEnd();
+    }
+}
+
+//DrawStatsOverlay
+//2 Parametros
+//Escribe sobre la ventana la última duración de cada fase, una por línea hacia arriba desde
+//(x, y): las de simulación del hilo que simula y las de dibujo del hilo de GLUT. Lee los valores que deja PERFIL_FASE, sin medir nada aparte.
+//Retorno nulo
+inline void DrawStatsOverlay(float x, float y) {
+#if PERFIL_ACTIVO
+    char line[64];
+    glColor3f(1.0f, 1.0f, 1.0f);
+    for (int p = 0; p < NUM_PHASES; p++) {
+        std::snprintf(line, sizeof(line), "%-12s %7.3f ms", PHASE_LABELS[p], profiler.LastMilliseconds(static_cast<Phase>(p)));
+        glRasterPos2f(x, y + 16.0f * p);
+        for (const char* c = line; *c != '\0'; c++) {
+            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *c);
+        }
+    }
+#else
+    (void)x;
+    (void)y;
+#endif
+}
+
+#endif
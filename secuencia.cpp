@@ -6,103 +6,198 @@
 #include <chrono>
 #include <random>
 #include <string>
-#include <cstdlib> // Librerías que importar
+#include <cstdlib>
+#include <cstring> // Librerías que importar
+#include "particulas.h"
+#include "grilla.h"
+#include "colisiones.h"
+#include "fases.h"
+#include "verlet.h"
+#include "politicas.h"
+#include "opciones.h"
+#include "medicion.h"
+#include "render.h"
+#include "reloj.h"
+#include "instantanea.h"
+#include "grabacion.h"
+#include "rasterizador.h"
+#include "aleatorio.h"
 
-const int WINDOW_WIDTH = 1920;
-const int WINDOW_HEIGHT = 1080; //Tamaño de la pantalla.
-const float PARTICLE_RADIUS = 60.0f; //Tamaño de las partículas.
-
-struct Particle {
-    float velocityX;
-    float velocityY;
-    float posX;
-    float posY;
-    float colorR;
-    float colorG;
-    float colorB;
-    float color_change;
-    float radius;
-
-    Particle(float vx, float vy, float x, float y, float r, float g, float b, float ch, float rad)
-        : velocityX(vx), velocityY(vy), posX(x), posY(y), colorR(r), colorG(g), colorB(b), color_change(ch), radius(rad) {}
-}; //Estructura para simular una particula. 
-
-std::vector<Particle> particles; //Vector para partículas.
+ParticleBuffers particles; //Frente y atrás de los arreglos (SoA) de las partículas.
+SpatialGrid grid; //Grilla para buscar vecinos.
+SpatialGrid collisionGrid; //Grilla para los choques (celdas del diámetro máximo).
+SpatialGrid verletGrid; //Grilla para construir las listas de Verlet (celdas del radio más el margen).
+VerletList verlet; //Listas de vecinos de Verlet (--verlet).
+bool verletEnabled = false;
+bool collisionsEnabled = false; //Choques entre partículas (--collisions).
+bool batchSubsteps = false;     //Una pasada de color, vecinos y choques por tanda (--batch-substeps).
+std::vector<float> sortedColorR, sortedColorG, sortedColorB; //Colores del frente en el orden de la grilla.
+InstancedRenderer renderer; //Dibujo con vertex buffer e instancias.
+FanRenderer fanRenderer; //Dibujo por abanicos en arreglos de vértices (--render fans).
+RenderMode renderMode = RENDER_INSTANCED;
 
 std::chrono::high_resolution_clock::time_point previousFrameTime; 
 int frameCount = 0;
 float fps = 0.0f; // Implementación de FPS.
+long long previousAllocations = 0;
+long long allocationsPerSecond = 0;
 
 int numParticlesToCreate = 0;
 bool creationFinished = false; //Cantidad de partículas y creación respectiva
+uint64_t simulationSeed = 0; //Semilla de todos los números aleatorios (--seed).
+SimulationClock simulationClock; //Paso fijo de simulación, independiente de los FPS.
+const char* snapshotPath = nullptr; //Instantánea inicial (--load).
+Checkpointer checkpointer; //Instantáneas periódicas (--checkpoint).
+RunRecord record; //Grabación de la corrida (--record) o la que se repite (--replay).
+const char* recordPath = nullptr;
+SoftwareRenderer softwareRenderer; //Dibujo por software, sin pantalla (--offscreen).
+FrameWriter frameWriter; //Imágenes o video de --offscreen (--output).
+bool offscreen = false;
+int offscreenFrame = 0;
+int offscreenFrames = 0;
+float simulationStep = 1.0f / DEFAULT_SIMULATION_HZ; //Segundos por paso (--hz).
 
 //CreateParticle
 //0 Parametros
 //Crear Partículas
 //Retorno nulo
 void CreateParticle() {
-    // Tomar el tiempo de inicio
-    std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now(); 
-    
+    ParticleSystem& front = particles.Front();
+
     // Creación secuencial de las partículas
     for (int i = 0; i < numParticlesToCreate; i++) {
-        std::random_device rd;
+        CounterRng generator(simulationSeed, RNG_STREAM_CREATE, i, 0);
         //Distribución aleatoria para crear las particulas basada en radio, color, posición y movimiento
-        std::mt19937 generator(rd());
-        std::uniform_real_distribution<float> randomRadius(20.0f, PARTICLE_RADIUS);
-        std::uniform_real_distribution<float> randomFloatX(-WINDOW_WIDTH / 2 + PARTICLE_RADIUS, WINDOW_WIDTH / 2 - PARTICLE_RADIUS);
-        std::uniform_real_distribution<float> randomFloatY(-WINDOW_HEIGHT / 2 + PARTICLE_RADIUS, WINDOW_HEIGHT / 2 - PARTICLE_RADIUS);
-        std::uniform_real_distribution<float> randomVelocity(-10.0f, 10.0f);
-        std::uniform_real_distribution<float> randomColor(0.0f, 1.0f);
-
-        float radius = randomRadius(generator);
-        float vx = randomVelocity(generator);
-        float vy = randomVelocity(generator);
-        float x = randomFloatX(generator);
-        float y = randomFloatY(generator);
-        float r = randomColor(generator);
-        float g = randomColor(generator);
-        float b = randomColor(generator);
-
-        particles[i] = Particle(vx, vy, x, y, r, g, b, 0.0f, radius);
+        float radius = generator.Uniform(20.0f, PARTICLE_RADIUS);
+        float vx = generator.Uniform(-MAX_SPEED, MAX_SPEED);
+        float vy = generator.Uniform(-MAX_SPEED, MAX_SPEED);
+        float x = generator.Uniform(-WINDOW_WIDTH / 2 + PARTICLE_RADIUS, WINDOW_WIDTH / 2 - PARTICLE_RADIUS);
+        float y = generator.Uniform(-WINDOW_HEIGHT / 2 + PARTICLE_RADIUS, WINDOW_HEIGHT / 2 - PARTICLE_RADIUS);
+        float r = generator.Uniform(0.0f, 1.0f);
+        float g = generator.Uniform(0.0f, 1.0f);
+        float b = generator.Uniform(0.0f, 1.0f);
+
+        front.velocityX[i] = vx;
+        front.velocityY[i] = vy;
+        front.posX[i] = x;
+        front.posY[i] = y;
+        front.colorR[i] = r;
+        front.colorG[i] = g;
+        front.colorB[i] = b;
+        front.color_change[i] = 0.0f;
+        front.radius[i] = radius;
+        front.previousX[i] = x;  // Sin movimiento previo que interpolar
+        front.previousY[i] = y;
         //Creación de las partículas
-    } 
-    
-    //Tiempo de ejecución para todas las particulas.
-    std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> totalTime = std::chrono::duration_cast<std::chrono::duration<double>>(endTime - startTime);
-    std::cout << "Tiempo de creación de partículas: " << totalTime.count() << " segundos\n";
+    }
+}
+//ParticleChecksum
+//0 Parametros
+//Suma del estado actual (el frente) para comparar una repetición con su grabación.
+//Retorno la suma, igual con cualquier cantidad de hilos
+uint64_t ParticleChecksum() {
+    HashChunks(particles.Front(), record.chunkHashes.data());
+    return CombineChunks(record.chunkHashes.data(), static_cast<int>(record.chunkHashes.size()), particles.step);
+}
+
+//RecordBatch
+//2 Parametros
+//Con --record, agrega a la grabación la tanda de substeps subpasos que empezó en start y,
+//si toca, la suma del estado nuevo.
+//Retorno nulo
+void RecordBatch(int substeps, Clock::time_point start) {
+    if (recordPath == nullptr) return;
+    if (record.AddBatch(substeps, std::chrono::duration<double>(Clock::now() - start).count())) {
+        record.AddChecksum(particles.step, ParticleChecksum());
+    }
+}
+
+//FinishRecording
+//0 Parametros
+//Con --record, agrega la suma del estado final y escribe la grabación.
+//Retorno nulo
+void FinishRecording() {
+    if (recordPath == nullptr) return;
+    if (record.NeedsFinalChecksum(particles.step)) {
+        record.AddChecksum(particles.step, ParticleChecksum());
+    }
+    if (record.Write(recordPath)) {
+        std::cout << "Grabación de " << record.steps << " tandas y " << record.checksums.size() << " sumas en " << recordPath << "\n";
+    } else {
+        std::cout << "No se pudo guardar la grabación en " << recordPath << "\n";
+    }
+}
+
+//CreateOrLoadParticles
+//0 Parametros
+//Estado inicial: la instantánea de --load (mapeada sin copiar) o, si no hay, partículas
+//aleatorias con CreateParticle. Con --record también guarda su suma.
+//Retorno nulo
+void CreateOrLoadParticles() {
+    SnapshotHeader header;
+    if (snapshotPath == nullptr) {
+        CreateParticle();
+    } else if (LoadSnapshot(snapshotPath, particles.Front(), header)) {
+        particles.step = static_cast<long long>(header.step); //El generador sigue donde quedó
+    } else {
+        std::cout << "No se pudo cargar " << snapshotPath << ". Se crean partículas nuevas.\n";
+        CreateParticle();
+    }
+    if (recordPath != nullptr) {
+        record.AddChecksum(particles.step, ParticleChecksum()); //Suma del estado inicial
+    }
+}
+
+//CheckpointIfDue
+//1 Parametro
+//Si la tanda de substeps subpasos llegó a una instantánea periódica, copia el frente a la copia del Checkpointer y se la
+//entrega a su hilo, que escribe el archivo sin detener la simulación.
+//Retorno nulo
+void CheckpointIfDue(int substeps) {
+    if (!checkpointer.Due(particles.step, substeps)) return;
+    CopyParticles(particles.Front(), checkpointer.staging);
+    checkpointer.Commit(particles.step);
 }
+
 //DrawParticulas
 //0 Parametros
 //Dibuja la particulas en la pantalla 
 //Retorno nulo
 void DrawParticles() {
     glClear(GL_COLOR_BUFFER_BIT);
+    const ParticleSystem& current = particles.Latest();  // Último estado simulado
+    const float t = simulationClock.InterpolationFactor(current.time, current.batchTime);
 
-    for (size_t i = 0; i < numParticlesToCreate; i++) {
-        // Dibujar el cuerpo (un círculo grande)
-        glColor3f(particles[i].colorR, particles[i].colorG, particles[i].colorB);
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(particles[i].posX, particles[i].posY);
-        const int numSegments = 64;
-        for (int j = 0; j <= numSegments; j++) {
-            float angle = j * 2.0f * M_PI / numSegments;
-            float dx = particles[i].radius * std::cos(angle);
-            float dy = particles[i].radius * std::sin(angle);
-            glVertex2f(particles[i].posX + dx, particles[i].posY + dy);
+    if (renderMode == RENDER_INSTANCED) {
+        {
+            PERFIL_FASE(PHASE_UPLOAD);
+            float* dst = renderer.BeginUpload(numParticlesToCreate);
+            PackInstances(dst, current, t);              // Copia de los datos al buffer
         }
-        glEnd();
-
+        PERFIL_FASE(PHASE_DRAW);
+        renderer.Draw();                                // Una sola llamada para todos los círculos
+    } else if (renderMode == RENDER_FANS) {
+        {
+            PERFIL_FASE(PHASE_UPLOAD);
+            fanRenderer.Build(current, t, ViewportScale()); // Vértices de los abanicos
+        }
+        PERFIL_FASE(PHASE_DRAW);
+        fanRenderer.Draw();                             // Una sola llamada para todos los abanicos
+    } else {
+        PERFIL_FASE(PHASE_DRAW);
+        DrawParticlesLegacy(current, t);                // Modo inmediato original
     }
+
    //Color y colocarlo en la pantalla.
     glColor3f(1.0f, 1.0f, 1.0f);
     glRasterPos2f(-WINDOW_WIDTH / 2 + 10, -WINDOW_HEIGHT / 2 + 10);
-    std::string fpsText = "FPS: " + std::to_string(static_cast<int>(fps));
+    char fpsText[64];                                   // En la pila: el frame no reserva memoria
+    std::snprintf(fpsText, sizeof(fpsText), "FPS: %d  Reservas/s: %lld", static_cast<int>(fps), allocationsPerSecond);
     //FPS.
-    for (char c : fpsText) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, c);
+    for (const char* c = fpsText; *c != '\0'; c++) {
+        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *c);
     }
+    DrawStatsOverlay(-WINDOW_WIDTH / 2 + 10, -WINDOW_HEIGHT / 2 + 26); //Tiempos por fase (sin efecto con -DSIN_PERFIL)
     //Hace el conteo de las frames per second basandose en el tiempo.
     frameCount++;
     std::chrono::high_resolution_clock::time_point currentFrameTime = std::chrono::high_resolution_clock::now();
@@ -110,116 +205,307 @@ void DrawParticles() {
     if (deltaTime >= 1.0f) {
         fps = static_cast<float>(frameCount) / deltaTime;
         frameCount = 0;
+        const long long allocations = HeapAllocations();  // Reservas del heap en el último segundo (memoria.h)
+        allocationsPerSecond = allocations - previousAllocations;
+        previousAllocations = allocations;
         previousFrameTime = currentFrameTime;
     }
     //Cambio de Buffers
-    glutSwapBuffers();
+    {
+        PERFIL_FASE(PHASE_SWAP);
+        glutSwapBuffers();
+    }
 }
-//UpdateParticle
-//0 Parametros
-//Actualiza la particulas a dibujar.
+//StepParticlesWith
+//3 Parametros
+//Avanza la simulación substeps pasos de deltaTime segundos. substeps es 1 salvo con
+//--batch-substeps (ver StepParticles): entonces la integración hace todos los subpasos en
+//una sola pasada por los arreglos y el cambio de color, los choques y el promedio de
+//vecinos se hacen una vez por tanda, con el tiempo total. Cada fase lee solo el frente
+//(estado anterior) y escribe solo atrás (estado nuevo), igual que paralela.cpp, para que
+//ambos programas calculen lo mismo. No hace llamadas a OpenGL, así se puede usar con
+//GLUT o en modo headless.
+//Policy (politicas.h) fija en compilación la búsqueda de vecinos y los choques; las fases
+//que la combinación no usa no existen en su instancia.
 //Retorno nulo
-void UpdateParticles(int value) {
-    std::chrono::high_resolution_clock::time_point currentFrameTime = std::chrono::high_resolution_clock::now();
-    float deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentFrameTime - previousFrameTime).count() / 1000.0f;
-    //Cambio para los tiempos y el framerate. 
-
-    //Secuencial de los updates para cada particula
-    for (size_t i = 0; i < numParticlesToCreate; i++) {
-        particles[i].posX += particles[i].velocityX * deltaTime;
-        particles[i].posY += particles[i].velocityY * deltaTime;
-        //Distribución aleatorio para los datos.
-        std::random_device rd;
-        std::default_random_engine generator(rd());
-        std::uniform_real_distribution<float> randomColor(0.0f, 1.0f);
-        std::uniform_int_distribution<int> randomInt(5, 10);
-
-        particles[i].color_change += deltaTime;
-        if (particles[i].color_change >= randomInt(generator)) {
-            particles[i].colorR = randomColor(generator);
-            particles[i].colorG = randomColor(generator);
-            particles[i].colorB = randomColor(generator);
-            particles[i].color_change = 0.0f;
-        } //Nuevos colores.
-
-        if (particles[i].posX < -WINDOW_WIDTH / 2 + particles[i].radius || particles[i].posX > WINDOW_WIDTH / 2 - particles[i].radius) {
-            particles[i].velocityX = -particles[i].velocityX;
+template <class Policy>
+void StepParticlesWith(ParticleBuffers& state, float deltaTime, int substeps) {
+    const ParticleSystem& front = state.Front();
+    ParticleSystem& back = state.Back();
+    const int n = front.count;
+    phaseTimer.Start();
+
+    {
+        PERFIL_FASE(PHASE_GRID);
+        if constexpr (Policy::neighbors == NEIGHBORS_VERLET) {
+            verlet.Update(verletGrid, front);          // Reconstruye solo si alguna partícula se movió más de medio margen
+        } else if constexpr (Policy::neighbors == NEIGHBORS_GRID) {
+            grid.Build(front.posX, front.posY, n);
+            //Se construye la grilla con las posiciones del frente.
+            grid.Gather(front.colorR, sortedColorR.data());
+            grid.Gather(front.colorG, sortedColorG.data());
+            grid.Gather(front.colorB, sortedColorB.data());
         }
-        if (particles[i].posY < -WINDOW_HEIGHT / 2 + particles[i].radius || particles[i].posY > WINDOW_HEIGHT / 2 - particles[i].radius) {
-            particles[i].velocityY = -particles[i].velocityY;
-        } //La nueva posición en el caso que si se topa en la pantalla.
-
-        // Cambiar el color de la partícula según el promedio de los colores de las partículas vecinas
-        float avgColorR = 0.0f, avgColorG = 0.0f, avgColorB = 0.0f;
-        int neighborCount = 0;
-
-       //Secuencial para ya haciendo la dirección de las partpiculas, y colores pasandose en sus vecinos y promedios.
-        for (size_t j = 0; j < numParticlesToCreate; j++) {
-            if (i != j) {
-                float distance = std::sqrt((particles[i].posX - particles[j].posX) * (particles[i].posX - particles[j].posX) + (particles[i].posY - particles[j].posY) * (particles[i].posY - particles[j].posY));
-
-                if (distance < 30) {
-                    avgColorR += particles[j].colorR;
-                    avgColorG += particles[j].colorG;
-                    avgColorB += particles[j].colorB;
-                    neighborCount++;
-                }
-            }
+    }
+    phaseTimer.Lap(PHASE_GRID);
+
+    {
+        PERFIL_FASE(PHASE_INTEGRATION);
+        IntegrateParticles(front, back, deltaTime, substeps);
+        //Cambio de posición basado en su velocidad (kernel SIMD).
+    }
+    phaseTimer.Lap(PHASE_INTEGRATION);
+
+    if constexpr (Policy::collisions) {
+        {
+            PERFIL_FASE(PHASE_COLLISIONS);
+            //Choques sobre las posiciones nuevas (atrás), con el mismo orden que paralela.cpp.
+            collisionGrid.Build(back.posX, back.posY, n);
+            collisionContacts += ResolveCollisions(back, collisionGrid);
         }
+        phaseTimer.Lap(PHASE_COLLISIONS);
+    }
 
-        if (neighborCount > 0) {
-            avgColorR /= neighborCount;
-            avgColorG /= neighborCount;
-            avgColorB /= neighborCount;
+    {
+        PERFIL_FASE(PHASE_COLOR);
+        //Secuencial de los updates para cada particula, con los mismos generadores que paralela.cpp.
+        ChangeColors(front, back, n, nullptr, simulationSeed, state.step, deltaTime * substeps); // fases.h
+    }
+    phaseTimer.Lap(PHASE_COLOR);
 
-            particles[i].colorR = avgColorR;
-            particles[i].colorG = avgColorG;
-            particles[i].colorB = avgColorB;
+    {
+        PERFIL_FASE(PHASE_NEIGHBORS);
+        if constexpr (Policy::neighbors == NEIGHBORS_VERLET) {
+            neighborPairs += verlet.AverageColors(back);   // Solo recorre las listas
+        } else if constexpr (Policy::neighbors == NEIGHBORS_GRID) {
+            neighborPairs += AverageNeighborColors(grid, sortedColorR.data(), sortedColorG.data(), sortedColorB.data(), n, back);
         }
     }
+    phaseTimer.Lap(PHASE_NEIGHBORS);
+
+    back.time = front.time + static_cast<double>(deltaTime) * substeps;
+    back.batchTime = static_cast<double>(deltaTime) * substeps;
+    state.Swap();
+    //El estado nuevo pasa a ser el frente.
+}
+
+//Una instancia de StepParticlesWith por combinación, en el orden de KernelIndex.
+const StepKernelTable STEP_KERNELS = MakeStepKernels([](auto policy) -> StepKernel { return StepParticlesWith<decltype(policy)>; });
+StepKernel stepKernel = STEP_KERNELS[0]; //Combinación elegida al inicio con las opciones.
 
+//StepParticles
+//3 Parametros
+//Avanza la simulación substeps pasos fijos con la combinación de fases elegida al inicio
+//(stepKernel). Por defecto cada subpaso es un paso completo, así el resultado no depende de
+//cómo el reloj agrupa los subpasos en tandas (ni de los FPS). Con --batch-substeps la tanda
+//se hace en una sola pasada: más rápido, pero el color, los vecinos y los choques se
+//calculan una vez por tanda. En los dos modos state.step cuenta subpasos.
+//Retorno nulo
+void StepParticles(ParticleBuffers& state, float deltaTime, int substeps) {
+    if (batchSubsteps) {
+        stepKernel(state, deltaTime, substeps);
+        state.step += substeps - 1;                     // Swap() avanzó uno
+        return;
+    }
+    for (int s = 0; s < substeps; s++) {
+        stepKernel(state, deltaTime, 1);
+    }
+}
+
+//PrepareKernel
+//1 Parametro
+//Para --kernels: elige la combinación kernel de STEP_KERNELS y vuelve al mismo estado
+//inicial, con las listas de Verlet sin construir.
+//Retorno nulo
+void PrepareKernel(int kernel) {
+    stepKernel = STEP_KERNELS[kernel];
+    particles.step = 0;
+    particles.Front().time = 0.0;
+    particles.Front().batchTime = 0.0;
+    verlet.Init(numParticlesToCreate, verlet.skin);
+    CreateOrLoadParticles();
+}
+
+//RenderOffscreen
+//0 Parametros
+//Con --offscreen dibuja el estado actual con el rasterizador por software y, si toca, guarda
+//la imagen (--output). El binning cuenta como subida, el rasterizado como dibujo y la
+//escritura como swap.
+//Retorno nulo
+void RenderOffscreen() {
+    const ParticleSystem& current = particles.Front();
+    phaseTimer.Start();
+    {
+        PERFIL_FASE(PHASE_UPLOAD);
+        softwareRenderer.Bin(current, 1.0f);            // Partículas a las listas de sus tiles
+    }
+    phaseTimer.Lap(PHASE_UPLOAD);
+    {
+        PERFIL_FASE(PHASE_DRAW);
+        softwareRenderer.Raster();
+    }
+    phaseTimer.Lap(PHASE_DRAW);
+    if (frameWriter.Wants(offscreenFrame, offscreenFrames)) {
+        PERFIL_FASE(PHASE_SWAP);
+        if (!frameWriter.Write(softwareRenderer, offscreenFrame)) {
+            std::cout << "No se pudo escribir el frame " << offscreenFrame << " en " << frameWriter.path << "\n";
+        }
+    }
+    phaseTimer.Lap(PHASE_SWAP);
+    offscreenFrame++;
+}
+
+//HeadlessStep
+//1 Parametro
+//Un paso del modo headless: simula, agrega la tanda a la grabación (--record), guarda la
+//instantánea si toca (--checkpoint) y dibuja por software (--offscreen).
+//Retorno nulo
+void HeadlessStep(float deltaTime) {
+    const Clock::time_point start = Clock::now();
+    StepParticles(particles, deltaTime, 1);
+    RecordBatch(1, start);
+    CheckpointIfDue(1);
+    if (offscreen) RenderOffscreen();
+}
+
+//UpdateParticle
+//0 Parametros
+//Función idle de GLUT. Simula los pasos fijos que pide el reloj según el tiempo real (uno
+//por uno, o en una pasada con --batch-substeps) y pide un nuevo dibujo, que interpola entre
+//los dos últimos estados.
+//Retorno nulo
+void UpdateParticles() {
+    const int substeps = simulationClock.Advance();
+    if (substeps > 0) {
+        const Clock::time_point start = Clock::now();
+        StepParticles(particles, simulationStep, substeps);
+        RecordBatch(substeps, start);
+        CheckpointIfDue(substeps);
+    }
     glutPostRedisplay();
-    glutTimerFunc(16, UpdateParticles, 0);
-    //Hace un nuevo display y cambia la función de tiempo
 }
 
 int main(int argc, char** argv) {
-        if (argc < 2) {
-        std::cout << "Uso por defecto de 10 partículas al no ingresar datos.\n";  //Se asegura que el usuario ingrese un input.
-        numParticlesToCreate = 10;
-    }else{
-
-    char* input = argv[1];
-
-    bool isNumber = false;
-    for (char* c = input; *c != '\0'; ++c) {
-        if (!std::isdigit(*c)) {
-            isNumber = true;
-            break;
+    Options opts = ParseOptions(argc, argv);             // Lee el número de partículas y las opciones
+    if (!opts.headless && std::getenv("DISPLAY") == nullptr) {
+        std::cout << "No hay servidor gráfico (DISPLAY). Se dibuja por software (--offscreen).\n";
+        opts.headless = true;                           // glutCreateWindow fallaría
+        opts.offscreen = true;
+    }
+    if (opts.outputPath != nullptr && std::strcmp(opts.outputPath, "-") == 0) {
+        std::cout.rdbuf(std::cerr.rdbuf());             // El video va a la salida estándar y los mensajes a stderr
+    }
+    numParticlesToCreate = opts.numParticles;
+    renderMode = opts.render;
+    simulationSeed = opts.hasSeed ? opts.seed : RandomSeed();
+    if (opts.loadPath != nullptr) {
+        SnapshotHeader header;
+        if (!ReadSnapshotHeader(opts.loadPath, header)) {
+            std::cout << "La instantánea " << opts.loadPath << " no existe o no es válida.\n";
+            return 1;
         }
+        numParticlesToCreate = static_cast<int>(header.count); // La instantánea define el tamaño
+        simulationSeed = header.seed;                          // y la semilla de la corrida
+        snapshotPath = opts.loadPath;
     }
-
-    if (isNumber) {
-        // Seguridad. Asegura que sea un entero positivo, menor de 15000 para velocidad
-        std::cout << "Debe de ingresar un número, no String.\n";
-        numParticlesToCreate = 10; //Programación Defensiva 
-    } else {
-         int number = std::stoi(input);
-         if (number > 15000){
-             std::cout << "Debe de ingresar un número mayor que 15000. Usando 10 por defecto.\n";
-             numParticlesToCreate = 10;
-         }
-        else if (number < 0){
-            std::cout << "No se ingreso un número positivo. Usando 10 por defecto.\n";
-            numParticlesToCreate = 10;
-        } else {
-            numParticlesToCreate = std::atoi(input);          // Obtiene el número de partículas a crear
+    if (opts.replayPath != nullptr) {
+        if (!record.Read(opts.replayPath)) {
+            std::cout << "La grabación " << opts.replayPath << " no existe o no es válida.\n";
+            return 1;
         }
-            
-    }}
+        numParticlesToCreate = static_cast<int>(record.header.count); // La grabación define la corrida:
+        simulationSeed = record.header.seed;                          // tamaño, semilla, paso, choques
+        opts.simulationHz = static_cast<int>(record.header.hz);       // y estado inicial
+        opts.collisions = record.header.collisions != 0;
+        opts.verlet = record.header.verletSkin > 0.0f;
+        opts.verletSkin = record.header.verletSkin;
+        opts.neighbors = record.header.neighborsOff == 0;
+        opts.batchSubsteps = record.header.batchSubsteps != 0;
+        snapshotPath = record.header.loadPath[0] != '\0' ? record.header.loadPath : nullptr;
+    }
+    simulationStep = 1.0f / opts.simulationHz;
+    std::cout << "Semilla: " << simulationSeed << "\n";        // Con --seed se repite la misma corrida
+#if PERFIL_ACTIVO
+    profiler.tracePath = opts.tracePath;
+    std::atexit(WriteTraceAtExit);                      // Exporta la traza al terminar (--trace)
+#else
+    if (opts.tracePath != nullptr) std::cout << "Compilado con -DSIN_PERFIL: --trace no tiene efecto.\n";
+#endif
+
     previousFrameTime = std::chrono::high_resolution_clock::now();
 
-    particles.reserve(numParticlesToCreate);                                // Reserva el espacio para las partículas
+    try {
+        particles.Allocate(numParticlesToCreate);       // Reserva los arreglos para las partículas
+        sortedColorR.resize(numParticlesToCreate);      // Colores ordenados por celda para el ciclo de vecinos
+        sortedColorG.resize(numParticlesToCreate);
+        sortedColorB.resize(numParticlesToCreate);
+    } catch (const std::bad_alloc&) {
+        std::cout << "No hay memoria para " << numParticlesToCreate << " partículas.\n";
+        return 1;
+    }
+    if (opts.checkpointPath != nullptr) {
+        checkpointer.Start(opts.checkpointPath, numParticlesToCreate, opts.checkpointEvery, simulationSeed);
+    }
+    grid.Init(-WINDOW_WIDTH / 2, -WINDOW_HEIGHT / 2, WINDOW_WIDTH, WINDOW_HEIGHT); // Grilla del tamaño de la ventana
+    collisionGrid.Init(-WINDOW_WIDTH / 2, -WINDOW_HEIGHT / 2, WINDOW_WIDTH, WINDOW_HEIGHT, COLLISION_CELL);
+    collisionsEnabled = opts.collisions;
+    batchSubsteps = opts.batchSubsteps;
+    if (opts.verlet) {
+        verletEnabled = true;                           // Listas de vecinos de Verlet (--verlet)
+        opts.verletSkin = ChooseVerletSkin(opts.verletSkin, simulationStep); // Margen según el paso
+        verlet.Init(numParticlesToCreate, opts.verletSkin);
+        verletGrid.Init(-WINDOW_WIDTH / 2, -WINDOW_HEIGHT / 2, WINDOW_WIDTH, WINDOW_HEIGHT, NEIGHBOR_RADIUS + opts.verletSkin);
+    }
+    const NeighborMode neighborMode = !opts.neighbors ? NEIGHBORS_OFF : verletEnabled ? NEIGHBORS_VERLET : NEIGHBORS_GRID;
+    stepKernel = STEP_KERNELS[KernelIndex(neighborMode, collisionsEnabled)]; // Paso especializado para las opciones
+
+    if (opts.kernels) {
+        if (!verletEnabled) {                           // Las combinaciones con Verlet necesitan sus listas
+            verlet.Init(numParticlesToCreate, DefaultVerletSkin(simulationStep));
+            verletGrid.Init(-WINDOW_WIDTH / 2, -WINDOW_HEIGHT / 2, WINDOW_WIDTH, WINDOW_HEIGHT, NEIGHBOR_RADIUS + verlet.skin);
+        }
+        RunKernelBenchmark(numParticlesToCreate, opts.steps, PrepareKernel, [](float dt) { StepParticles(particles, dt, 1); }, simulationStep, opts.csv);
+        return 0;                                       // Compara las combinaciones de fases (--kernels)
+    }
+
+    if (opts.threads > 0 || opts.pin != PIN_NONE) {
+        std::cout << "--threads y --pin solo aplican a paralela.cpp.\n";
+    }
+
+    if (opts.verify) {
+        const int kernels = VerifyKernels(particles, verlet, verletEnabled, opts.steps, simulationStep, CreateOrLoadParticles,
+                                          StepParticles, 1); // Dos corridas secuenciales deben ser idénticas
+        return VerifyChecksumSpacing() != 0 ? 1 : kernels; // y revisa dónde van las sumas de --record
+    }
+
+    if (opts.replayPath != nullptr) {
+        return RunReplay(record, CreateOrLoadParticles, [](float dt, int substeps) { StepParticles(particles, dt, substeps); }, ParticleChecksum, opts.csv); // Repite la grabación
+    }
+    if (opts.recordPath != nullptr) {
+        recordPath = opts.recordPath;                   // Graba semilla, parámetros, tandas y sumas
+        record.Begin(simulationSeed, numParticlesToCreate, opts.simulationHz, collisionsEnabled, opts.verletSkin, opts.neighbors, opts.batchSubsteps, opts.checksumEvery, snapshotPath);
+    }
+
+    if (opts.offscreen) {
+        offscreen = true;
+        offscreenFrames = opts.steps;
+        softwareRenderer.Init(WINDOW_WIDTH, WINDOW_HEIGHT, numParticlesToCreate); // Imagen del tamaño de la ventana
+        if (opts.outputPath != nullptr && !frameWriter.Open(opts.outputPath, WINDOW_WIDTH, WINDOW_HEIGHT)) {
+            std::cout << "No se pudo abrir " << opts.outputPath << ".\n";
+            return 1;
+        }
+    }
+    if (opts.headless) {
+        const long long steadyAllocations = RunHeadless(numParticlesToCreate, opts.steps, simulationStep, CreateOrLoadParticles, HeadlessStep, opts.csv); // Simulación sin ventana
+        if (verletEnabled) verlet.Report(neighborPairs);   // Reconstrucciones y ahorro (--verlet)
+        checkpointer.Finish(particles.Front(), particles.step);
+        FinishRecording();                              // Escribe la grabación (--record)
+        frameWriter.Close();
+        if (opts.checkAlloc) {
+            return CheckSteadyAllocations(steadyAllocations); // Falla si los pasos reservan memoria (--check-alloc)
+        }
+        return 0;
+    }
 
     glutInit(&argc, argv);                              // Inicializa GLUT
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);        // Habilita el doble buffer y el modelo de color RGB
@@ -235,11 +521,23 @@ int main(int argc, char** argv) {
     glMatrixMode(GL_MODELVIEW);                         // Establece la matriz de vista del modelo
     glLoadIdentity();                                   // Carga la matriz identidad
 
-    CreateParticle();                                   // Inicia la simulación de partículas
+    if (renderMode == RENDER_INSTANCED && !renderer.Init(numParticlesToCreate)) {
+        std::cout << "Usando el dibujo legacy.\n";       // Si no hay soporte se usa el modo inmediato
+        renderMode = RENDER_LEGACY;
+    }
+    if (renderMode == RENDER_FANS) {
+        fanRenderer.Init();                             // Carga glMultiDrawArrays
+    }
+
+    CreateOrLoadParticles();                            // Inicia la simulación de partículas (o carga --load)
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);               // Establece el color de fondo
     glutDisplayFunc(DrawParticles);                     // Establece la función de dibujo
-    glutTimerFunc(0, UpdateParticles, 0);               // Establece la función de actualización
+    simulationClock.Start(simulationStep);              // El reloj empieza con la primera imagen
+    glutIdleFunc(UpdateParticles);                      // Simula entre frames, sin esperar a un timer
+    glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS); // Para guardar al cerrar
     glutMainLoop();                                     // Inicia el ciclo de dibujo
+    checkpointer.Finish(particles.Front(), particles.step); // Guarda el estado final (--checkpoint)
+    FinishRecording();                                  // Escribe la grabación (--record)
     return 0;
 }
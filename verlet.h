@@ -0,0 +1,310 @@
+#ifndef VERLET_H
+#define VERLET_H
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <omp.h>
+#include "particulas.h"
+#include "grilla.h" // Librerías que importar
+
+//Posición y color de una partícula en el orden de las listas. Juntos (y alineados a 32
+//bytes) cada vecino de la lista se lee de una sola línea de caché en vez de cinco arreglos.
+struct alignas(32) VerletEntry {
+    float x, y, r, g, b;
+};
+
+//MaxStepMove
+//1 Parametro
+//Lo más que avanza una partícula en un paso de step segundos: cada componente de la
+//velocidad va de -MAX_SPEED a MAX_SPEED, así que la rapidez llega a MAX_SPEED * raíz de 2.
+//Retorno la distancia en píxeles
+inline float MaxStepMove(float step) {
+    return MAX_SPEED * 1.41421356f * step;
+}
+
+//DefaultVerletSkin
+//1 Parametro
+//Margen de --verlet sin valor: 2.5 veces lo más que avanza una partícula en un paso, así la
+//mitad del margen alcanza para más de un paso aun a la velocidad máxima (35 px a 60 Hz).
+//Retorno el margen en píxeles
+inline float DefaultVerletSkin(float step) {
+    return 2.5f * MaxStepMove(step);
+}
+
+//ChooseVerletSkin
+//2 Parametros
+//Margen de las listas con el que pidió el usuario (0 si no dio uno). Avisa si la mitad de
+//ese margen no supera lo que avanza una partícula en un paso, porque entonces las listas se
+//reconstruirían casi en cada paso.
+//Retorno el margen en píxeles
+inline float ChooseVerletSkin(float requested, float step) {
+    if (requested <= 0.0f) return DefaultVerletSkin(step);
+    if (0.5f * requested <= MaxStepMove(step)) {
+        std::cout << "Aviso: con margen " << requested << " px las listas de Verlet no duran más de un paso (una partícula avanza hasta "
+                  << MaxStepMove(step) << " px por paso). Use un margen mayor que " << 2.0f * MaxStepMove(step) << " px o más --hz.\n";
+    }
+    return requested;
+}
+
+//Listas de vecinos de Verlet (--verlet). Cada partícula guarda, en formato CSR, las
+//partículas a menos de NEIGHBOR_RADIUS + skin cuando se construyeron las listas. Mientras
+//ninguna partícula se haya movido más de skin / 2 desde entonces, dos partículas a menos de
+//NEIGHBOR_RADIUS siguen estando en la lista de la otra, así que los pasos siguientes solo
+//recorren las listas, sin reconstruir la grilla. Las partículas se numeran en el orden de la
+//grilla al construir (posición k), y en cada paso se copian posiciones y colores a ese orden
+//para que el recorrido lea memoria cercana.
+struct VerletList {
+    float skin = 0.0f;
+    bool built = false;
+    int moved = 0;                     // Alguna partícula se movió más de skin / 2 (escrito con omp atomic)
+
+    std::vector<int> order;            // Partícula en la posición k (orden de la grilla al construir)
+    std::vector<int> start;            // Inicio de la lista de cada posición (n + 1)
+    std::vector<int> neighbors;        // Posiciones de los vecinos candidatos, seguidas
+    std::vector<float> buildX;         // Posición de cada partícula al construir
+    std::vector<float> buildY;
+    std::vector<VerletEntry> ordered;  // Estado actual en el orden de order
+    std::vector<int> threadCount;      // Candidatos por hilo, luego sus inicios
+    std::vector<std::vector<int>> threadNeighbors; // Candidatos de cada hilo antes de copiarlos (dimensionados en Init)
+
+    long long rebuilds = 0;            // Estadísticas para Report()
+    long long updates = 0;
+    long long candidates = 0;          // Suma del largo de las listas en cada paso
+    double rebuildSeconds = 0.0;
+    double reuseSeconds = 0.0;
+
+    //Init
+    //2 Parametros
+    //Reserva las listas para n partículas con un margen de skinWidth píxeles. El largo de
+    //las listas se acota con la densidad de la ventana: en promedio cada partícula tiene
+    //n / área * pi * (NEIGHBOR_RADIUS + skin)^2 candidatos, y se reserva una vez y media (nunca más
+    //de n) para que las reconstrucciones no vuelvan a reservar memoria.
+    //Retorno nulo
+    void Init(int n, float skinWidth) {
+        skin = skinWidth;
+        built = false;
+        order.resize(n);
+        start.assign(n + 1, 0);
+        buildX.resize(n);
+        buildY.resize(n);
+        ordered.resize(n);
+
+        const double reach = NEIGHBOR_RADIUS + skin;
+        const double density = static_cast<double>(n) / (static_cast<double>(WINDOW_WIDTH) * WINDOW_HEIGHT);
+        const size_t perParticle = std::min<size_t>(n, static_cast<size_t>(1.5 * density * 3.14159265 * reach * reach) + 32);
+        const size_t perRange = std::min<size_t>(n, static_cast<size_t>(1.5 * density * 3.0 * reach * reach) + 32); //Una fila de 3 celdas
+        const int numThreads = omp_get_max_threads();
+        neighbors.resize(static_cast<size_t>(n) * perParticle);
+        threadNeighbors.resize(numThreads);
+        for (std::vector<int>& mine : threadNeighbors) {
+            mine.resize((static_cast<size_t>(n) / numThreads + 1) * perParticle + perRange); //Bloque del hilo más el rango que se escribe de más
+        }
+    }
+
+    //Stale
+    //1 Parametro
+    //Revisa si alguna partícula se movió más de skin / 2 desde la última construcción.
+    //"omp for" huérfano; todos los hilos reciben el mismo resultado.
+    //Retorno verdadero si hay que reconstruir las listas
+    bool Stale(const ParticleSystem& p) {
+        if (!built) return true;
+        const float limit2 = 0.25f * skin * skin;
+        #pragma omp single
+        moved = 0;
+
+        float farthest2 = 0.0f;
+        #pragma omp for schedule(static)
+        for (int begin = 0; begin < p.count; begin += INTEGRATION_BLOCK) {
+            const int end = std::min(begin + INTEGRATION_BLOCK, p.count);
+            float block2 = 0.0f;
+            #pragma omp simd reduction(max:block2)
+            for (int i = begin; i < end; i++) {
+                const float dx = p.posX[i] - buildX[i];
+                const float dy = p.posY[i] - buildY[i];
+                block2 = std::max(block2, dx * dx + dy * dy);
+            }
+            farthest2 = std::max(farthest2, block2);
+        }
+        if (farthest2 > limit2) {
+            #pragma omp atomic write
+            moved = 1;
+        }
+        #pragma omp barrier
+        int result;
+        #pragma omp atomic read
+        result = moved;
+        return result != 0;
+    }
+
+    //Build
+    //2 Parametros
+    //Construye las listas con cells ya construida sobre las posiciones de p (sortedX/Y en el
+    //orden de la grilla). Las celdas de cells deben medir al menos NEIGHBOR_RADIUS + skin.
+    //Cada hilo recorre las celdas una sola vez para un bloque contiguo de posiciones y
+    //guarda sus candidatos en su propio arreglo; una suma prefija por hilo da dónde copia
+    //cada uno, así las listas son las mismas con cualquier cantidad de hilos. Debe llamarse
+    //desde todos los hilos del equipo.
+    //Retorno nulo
+    void Build(const SpatialGrid& cells, const ParticleSystem& p) {
+        const int n = p.count;
+        const float cutoff2 = (NEIGHBOR_RADIUS + skin) * (NEIGHBOR_RADIUS + skin);
+        const int tid = omp_get_thread_num();
+        const int numThreads = omp_get_num_threads();
+
+        #pragma omp single
+        {
+            threadCount.assign(numThreads + 1, 0);
+            if (threadNeighbors.size() < static_cast<size_t>(numThreads)) threadNeighbors.resize(numThreads);
+        }
+
+        const int begin = static_cast<int>(static_cast<long long>(n) * tid / numThreads);
+        const int end = static_cast<int>(static_cast<long long>(n) * (tid + 1) / numThreads);
+
+        //Candidatos del bloque en el arreglo del hilo; start[k] queda relativo a ese arreglo.
+        std::vector<int>& mine = threadNeighbors[tid];
+        int count = 0;
+        for (int k = begin; k < end; k++) {
+            start[k] = count;
+            const float x = cells.sortedX[k], y = cells.sortedY[k];
+            cells.ForEachCandidateRange(x, y, [&](int first, int last) {
+                if (mine.size() < static_cast<size_t>(count + last - first)) mine.resize(2 * (count + last - first));
+                int* out = mine.data();
+                const float* sortedX = cells.sortedX.data();
+                const float* sortedY = cells.sortedY.data();
+                int next = count;                   //Copia local: out podría apuntar a count para el compilador
+                for (int m = first; m < last; m++) {
+                    const float dx = x - sortedX[m];
+                    const float dy = y - sortedY[m];
+                    out[next] = m;
+                    next += (dx * dx + dy * dy < cutoff2) & (m != k); //Sin saltos: se escribe siempre y se avanza si es vecino
+                }
+                count = next;
+            });
+        }
+        threadCount[tid + 1] = count;
+        #pragma omp barrier
+
+        #pragma omp single
+        {
+            for (int t = 0; t < numThreads; t++) threadCount[t + 1] += threadCount[t];
+            if (neighbors.size() < static_cast<size_t>(threadCount[numThreads])) {
+                neighbors.resize(threadCount[numThreads]); //Solo si la densidad local supera la cota de Init
+            }
+            start[n] = threadCount[numThreads];
+        }
+
+        //Cada hilo copia su arreglo a su lugar y corre los inicios de su bloque.
+        const int offset = threadCount[tid];
+        std::copy(mine.begin(), mine.begin() + count, neighbors.begin() + offset);
+        for (int k = begin; k < end; k++) start[k] += offset;
+
+        //Orden de las posiciones y posiciones de referencia para Stale().
+        #pragma omp for schedule(static)
+        for (int k = 0; k < n; k++) {
+            const int i = cells.cellIndex[k];
+            order[k] = i;
+            buildX[i] = cells.sortedX[k];
+            buildY[i] = cells.sortedY[k];
+        }
+        #pragma omp single
+        built = true;
+    }
+
+    //Gather
+    //1 Parametro
+    //Copia posición y color del estado actual al orden de las listas. "omp for" huérfano.
+    //Retorno nulo
+    void Gather(const ParticleSystem& p) {
+        #pragma omp for schedule(static)
+        for (int k = 0; k < p.count; k++) {
+            const int i = order[k];
+            ordered[k] = { p.posX[i], p.posY[i], p.colorR[i], p.colorG[i], p.colorB[i] };
+        }
+    }
+
+    //Update
+    //2 Parametros
+    //Preparación de las listas para un paso sobre las posiciones de p: si están vencidas
+    //reconstruye cells y las listas, y luego copia el estado al orden de las listas. Mide
+    //su propio tiempo para Report(). Debe llamarse desde todos los hilos del equipo.
+    //Retorno nulo
+    void Update(SpatialGrid& cells, const ParticleSystem& p) {
+        const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        const bool rebuild = Stale(p);
+        if (rebuild) {
+            cells.Build(p.posX, p.posY, p.count);
+            Build(cells, p);
+        }
+        Gather(p);
+        #pragma omp master
+        {
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            (rebuild ? rebuildSeconds : reuseSeconds) += seconds;
+            rebuilds += rebuild;
+            updates++;
+            candidates += start[p.count];
+        }
+    }
+
+    //AverageColors
+    //1 Parametro
+    //Promedio de color de los vecinos a menos de NEIGHBOR_RADIUS, recorriendo solo las
+    //listas; escribe en back las partículas con vecinos. "omp for" huérfano con el schedule
+    //de --schedule.
+    //Retorno los pares vecinos encontrados por este hilo (el que llama los suma)
+    long long AverageColors(ParticleSystem& back) const {
+        const int n = back.count;
+        long long pairs = 0;
+        #pragma omp for schedule(runtime)
+        for (int k = 0; k < n; k++) {
+            const float x = ordered[k].x, y = ordered[k].y;
+            float avgColorR = 0.0f, avgColorG = 0.0f, avgColorB = 0.0f;
+            int neighborCount = 0;
+
+            #pragma omp simd reduction(+:avgColorR, avgColorG, avgColorB, neighborCount)
+            for (int e = start[k]; e < start[k + 1]; e++) {
+                const VerletEntry& other = ordered[neighbors[e]];
+                const float dx = x - other.x;
+                const float dy = y - other.y;
+                const bool neighbor = dx * dx + dy * dy < NEIGHBOR_RADIUS * NEIGHBOR_RADIUS;
+                avgColorR += neighbor ? other.r : 0.0f;
+                avgColorG += neighbor ? other.g : 0.0f;
+                avgColorB += neighbor ? other.b : 0.0f;
+                neighborCount += neighbor;
+            }
+
+            if (neighborCount > 0) {
+                const int i = order[k];
+                back.colorR[i] = avgColorR / neighborCount;
+                back.colorG[i] = avgColorG / neighborCount;
+                back.colorB[i] = avgColorB / neighborCount;
+            }
+            pairs += neighborCount;
+        }
+        return pairs;
+    }
+
+    //Report
+    //2 Parametros
+    //Imprime cada cuánto se reconstruyeron las listas, cuántos candidatos tienen, cuántos
+    //de ellos fueron vecinos (pairs) y cuánto se ahorra por paso frente a reconstruir siempre.
+    //Retorno nulo
+    void Report(long long pairs) const {
+        if (updates == 0) return;
+        const long long reuses = updates - rebuilds;
+        const double rebuildMs = rebuilds > 0 ? rebuildSeconds / rebuilds * 1e3 : 0.0;
+        const double reuseMs = reuses > 0 ? reuseSeconds / reuses * 1e3 : 0.0;
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Listas de Verlet (margen " << skin << " px): " << rebuilds << " reconstrucciones en " << updates
+                  << " pasos (cada " << static_cast<double>(updates) / std::max(rebuilds, 1LL) << " pasos)\n";
+        std::cout << "  Candidatos por partícula: " << static_cast<double>(candidates) / updates / std::max<size_t>(order.size(), 1)
+                  << ", vecinos reales: " << (candidates > 0 ? 100.0 * pairs / candidates : 0.0) << "%\n";
+        std::cout << "  Preparación por paso: " << rebuildMs << " ms al reconstruir, " << reuseMs << " ms al reutilizar"
+                  << "; ahorro promedio " << (rebuildMs - reuseMs) * reuses / updates << " ms/paso\n";
+    }
+};
+
+#endif